@@ -0,0 +1,44 @@
+//
+//  NJKURLParts.h
+//
+//  Created by Satoshi Aasano on 4/20/13.
+//  Copyright (c) 2013 Satoshi Asano. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+// Every frame and iframe request passes through the delegate on the main thread,
+// so URLs are parsed in a single pass over the existing string buffer, rather
+// than building new strings for each comparison.
+
+typedef NS_ENUM(NSInteger, NJKURLScheme) {
+    NJKURLSchemeOther,
+    NJKURLSchemeHTTP,
+    NJKURLSchemeHTTPS,
+    NJKURLSchemeFile
+};
+
+// The ranges of each part of a URL string. Parts that aren't present have a location of kCFNotFound.
+typedef struct {
+    CFStringInlineBuffer buffer;
+    CFRange scheme;
+    CFRange host;
+    CFRange path;
+    CFRange query;
+    CFRange fragment;
+    NSInteger port;
+    NJKURLScheme schemeType;
+} NJKURLParts;
+
+// Parses the URL string into its parts. The parts don't retain the string, so it must stay alive for as long as
+// the parts are used (eg, hold it in an NS_VALID_UNTIL_END_OF_SCOPE local, rather than passing a temporary).
+void NJKURLPartsInit(NJKURLParts *parts, NSString *string);
+
+// Compares a part of the URL with an ASCII string.
+BOOL NJKURLRangeEqualsASCII(NJKURLParts *parts, CFRange range, const char *string, BOOL caseInsensitive);
+
+// Compares two parsed URLs, ignoring scheme/host case and default ports.
+BOOL NJKURLPartsAreEquivalent(NJKURLParts *a, NJKURLParts *b, BOOL ignoringFragment);
+
+// Convenience for comparing two URLs that haven't been parsed yet.
+BOOL NJKURLsAreEquivalent(NSURL *a, NSURL *b, BOOL ignoringFragment);
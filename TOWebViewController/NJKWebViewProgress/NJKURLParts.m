@@ -0,0 +1,215 @@
+//
+//  NJKURLParts.m
+//
+//  Created by Satoshi Aasano on 4/20/13.
+//  Copyright (c) 2013 Satoshi Asano. All rights reserved.
+//
+
+#import "NJKURLParts.h"
+
+static inline UniChar NJKURLCharacterAtIndex(NJKURLParts *parts, CFIndex index)
+{
+    return CFStringGetCharacterFromInlineBuffer(&parts->buffer, index);
+}
+
+static inline UniChar NJKLowercaseCharacter(UniChar character)
+{
+    return (character >= 'A' && character <= 'Z') ? (character + ('a' - 'A')) : character;
+}
+
+BOOL NJKURLRangeEqualsASCII(NJKURLParts *parts, CFRange range, const char *string, BOOL caseInsensitive)
+{
+    size_t length = strlen(string);
+    if (range.location == kCFNotFound || range.length != (CFIndex)length) {
+        return NO;
+    }
+    
+    for (CFIndex i = 0; i < range.length; i++) {
+        UniChar character = NJKURLCharacterAtIndex(parts, range.location + i);
+        if (caseInsensitive) {
+            character = NJKLowercaseCharacter(character);
+        }
+        
+        if (character != (UniChar)string[i]) {
+            return NO;
+        }
+    }
+    
+    return YES;
+}
+
+void NJKURLPartsInit(NJKURLParts *parts, NSString *string)
+{
+    CFStringRef urlString = string ? (__bridge CFStringRef)string : CFSTR("");
+    CFIndex length = CFStringGetLength(urlString);
+    CFStringInitInlineBuffer(urlString, &parts->buffer, CFRangeMake(0, length));
+    
+    CFRange notFound = CFRangeMake(kCFNotFound, 0);
+    parts->scheme = parts->host = parts->query = parts->fragment = notFound;
+    parts->path = CFRangeMake(0, 0);
+    parts->port = -1;
+    parts->schemeType = NJKURLSchemeOther;
+    
+    //Scheme, up to the first ':' (if the characters before it are valid scheme characters)
+    CFIndex cursor = 0;
+    for (CFIndex i = 0; i < length; i++) {
+        UniChar character = NJKURLCharacterAtIndex(parts, i);
+        if (character == ':') {
+            if (i > 0) {
+                parts->scheme = CFRangeMake(0, i);
+                cursor = i + 1;
+            }
+            break;
+        }
+        
+        BOOL isSchemeCharacter = (character < 128) && (isalnum(character) || character == '+' || character == '-' || character == '.');
+        if (!isSchemeCharacter) {
+            break;
+        }
+    }
+    
+    //Fragment and query mark the end of the hierarchical part
+    CFIndex end = length;
+    for (CFIndex i = cursor; i < length; i++) {
+        UniChar character = NJKURLCharacterAtIndex(parts, i);
+        if (character == '#') {
+            parts->fragment = CFRangeMake(i + 1, length - (i + 1));
+            end = i;
+            break;
+        }
+    }
+    
+    for (CFIndex i = cursor; i < end; i++) {
+        if (NJKURLCharacterAtIndex(parts, i) == '?') {
+            parts->query = CFRangeMake(i + 1, end - (i + 1));
+            end = i;
+            break;
+        }
+    }
+    
+    //Authority (user info is skipped, host and port are kept)
+    if (end - cursor >= 2 && NJKURLCharacterAtIndex(parts, cursor) == '/' && NJKURLCharacterAtIndex(parts, cursor + 1) == '/') {
+        CFIndex authorityStart = cursor + 2;
+        CFIndex authorityEnd = authorityStart;
+        while (authorityEnd < end && NJKURLCharacterAtIndex(parts, authorityEnd) != '/') {
+            authorityEnd++;
+        }
+        
+        CFIndex hostStart = authorityStart;
+        for (CFIndex i = authorityStart; i < authorityEnd; i++) {
+            if (NJKURLCharacterAtIndex(parts, i) == '@') {
+                hostStart = i + 1;
+            }
+        }
+        
+        CFIndex hostEnd = authorityEnd;
+        BOOL insideBrackets = NO;
+        for (CFIndex i = hostStart; i < authorityEnd; i++) {
+            UniChar character = NJKURLCharacterAtIndex(parts, i);
+            if (character == '[') { insideBrackets = YES; }
+            else if (character == ']') { insideBrackets = NO; }
+            else if (character == ':' && !insideBrackets) {
+                hostEnd = i;
+                break;
+            }
+        }
+        
+        parts->host = CFRangeMake(hostStart, hostEnd - hostStart);
+        
+        if (hostEnd < authorityEnd) {
+            NSInteger port = 0;
+            for (CFIndex i = hostEnd + 1; i < authorityEnd; i++) {
+                UniChar character = NJKURLCharacterAtIndex(parts, i);
+                if (character < '0' || character > '9') { break; }
+                port = (port * 10) + (character - '0');
+            }
+            
+            if (authorityEnd > hostEnd + 1) {
+                parts->port = port;
+            }
+        }
+        
+        cursor = authorityEnd;
+    }
+    
+    parts->path = CFRangeMake(cursor, end - cursor);
+    
+    //Classify the scheme, and fill in its default port if one wasn't specified
+    if (NJKURLRangeEqualsASCII(parts, parts->scheme, "http", YES)) {
+        parts->schemeType = NJKURLSchemeHTTP;
+        if (parts->port < 0) { parts->port = 80; }
+    }
+    else if (NJKURLRangeEqualsASCII(parts, parts->scheme, "https", YES)) {
+        parts->schemeType = NJKURLSchemeHTTPS;
+        if (parts->port < 0) { parts->port = 443; }
+    }
+    else if (NJKURLRangeEqualsASCII(parts, parts->scheme, "file", YES)) {
+        parts->schemeType = NJKURLSchemeFile;
+    }
+}
+
+static BOOL NJKURLRangesAreEqual(NJKURLParts *a, CFRange aRange, NJKURLParts *b, CFRange bRange, BOOL caseInsensitive)
+{
+    if (aRange.location == kCFNotFound || bRange.location == kCFNotFound) {
+        return (aRange.location == bRange.location);
+    }
+    
+    if (aRange.length != bRange.length) {
+        return NO;
+    }
+    
+    for (CFIndex i = 0; i < aRange.length; i++) {
+        UniChar aCharacter = NJKURLCharacterAtIndex(a, aRange.location + i);
+        UniChar bCharacter = NJKURLCharacterAtIndex(b, bRange.location + i);
+        if (caseInsensitive) {
+            aCharacter = NJKLowercaseCharacter(aCharacter);
+            bCharacter = NJKLowercaseCharacter(bCharacter);
+        }
+        
+        if (aCharacter != bCharacter) {
+            return NO;
+        }
+    }
+    
+    return YES;
+}
+
+static BOOL NJKURLPathsAreEqual(NJKURLParts *a, NJKURLParts *b)
+{
+    //An empty path on a URL with a host is the same as the root path
+    if (a->host.location != kCFNotFound && b->host.location != kCFNotFound) {
+        if (a->path.length == 0 && b->path.length == 1) {
+            return NJKURLCharacterAtIndex(b, b->path.location) == '/';
+        }
+        
+        if (b->path.length == 0 && a->path.length == 1) {
+            return NJKURLCharacterAtIndex(a, a->path.location) == '/';
+        }
+    }
+    
+    return NJKURLRangesAreEqual(a, a->path, b, b->path, NO);
+}
+
+BOOL NJKURLPartsAreEquivalent(NJKURLParts *a, NJKURLParts *b, BOOL ignoringFragment)
+{
+    return NJKURLRangesAreEqual(a, a->scheme, b, b->scheme, YES) &&
+           NJKURLRangesAreEqual(a, a->host, b, b->host, YES) &&
+           a->port == b->port &&
+           NJKURLPathsAreEqual(a, b) &&
+           NJKURLRangesAreEqual(a, a->query, b, b->query, NO) &&
+           (ignoringFragment || NJKURLRangesAreEqual(a, a->fragment, b, b->fragment, NO));
+}
+
+BOOL NJKURLsAreEquivalent(NSURL *a, NSURL *b, BOOL ignoringFragment)
+{
+    if (a == b) { return YES; }
+    if (a == nil || b == nil) { return NO; }
+    
+    NS_VALID_UNTIL_END_OF_SCOPE NSString *aString = a.absoluteString;
+    NS_VALID_UNTIL_END_OF_SCOPE NSString *bString = b.absoluteString;
+    
+    NJKURLParts aParts, bParts;
+    NJKURLPartsInit(&aParts, aString);
+    NJKURLPartsInit(&bParts, bString);
+    return NJKURLPartsAreEquivalent(&aParts, &bParts, ignoringFragment);
+}
@@ -32,5 +32,8 @@ typedef void (^NJKWebViewProgressBlock)(float progress);
 
 @protocol NJKWebViewProgressDelegate <NSObject>
 - (void)webViewProgress:(NJKWebViewProgress *)webViewProgress updateProgress:(float)progress;
+@optional
+// Return NO if the failure has been handled by starting another load, so progress shouldn't be completed for it
+- (BOOL)webViewProgress:(NJKWebViewProgress *)webViewProgress shouldCompleteProgressForError:(NSError *)error;
 @end
 
@@ -6,8 +6,25 @@
 //
 
 #import "NJKWebViewProgress.h"
+#import "NJKURLParts.h"
 
-NSString *completeRPCURLPath = @"/njkwebviewprogressproxy/complete";
+#define NJK_COMPLETE_RPC_PATH       "/njkwebviewprogressproxy/complete"
+#define NJK_INTERACTIVE_RPC_PATH    "/njkwebviewprogressproxy/interactive"
+
+NSString *completeRPCURLPath = @NJK_COMPLETE_RPC_PATH;
+
+// Installed once per document. Rather than polling document.readyState after every frame,
+// the page reports its DOM interactive and load events back to us as RPC requests.
+// The current ready state is returned so nothing is missed if those events already fired.
+static NSString *const NJKDocumentObserverJS =
+    @"(function(d,w){var r=d.readyState;"
+    @"if(w.__njkProgressObserver||r=='complete'){return r;}"
+    @"w.__njkProgressObserver=true;"
+    @"var rpc=function(p){var f=d.createElement('iframe');f.style.display='none';"
+    @"f.src=w.location.protocol+'//'+w.location.host+p;(d.body||d.documentElement).appendChild(f);};"
+    @"if(r!='interactive'){d.addEventListener('DOMContentLoaded',function(){rpc('" NJK_INTERACTIVE_RPC_PATH "');},false);}"
+    @"w.addEventListener('load',function(){rpc('" NJK_COMPLETE_RPC_PATH "');},false);"
+    @"return r;})(document,window);";
 
 const float NJKInitialProgressValue = 0.1f;
 const float NJKInteractiveProgressValue = 0.5f;
@@ -19,6 +36,7 @@ const float NJKFinalProgressValue = 0.9f;
     NSUInteger _maxLoadCount;
     NSURL *_currentURL;
     BOOL _interactive;
+    BOOL _observingDocument;
 }
 
 - (id)init
@@ -40,6 +58,11 @@ const float NJKFinalProgressValue = 0.9f;
 
 - (void)incrementProgress
 {
+    // Nothing to measure against if a new load reset us in the meantime
+    if (_maxLoadCount == 0) {
+        return;
+    }
+    
     float progress = self.progress;
     float maxProgress = _interactive ? NJKFinalProgressValue : NJKInteractiveProgressValue;
     float remainPercent = (float)_loadingCount / (float)_maxLoadCount;
@@ -72,6 +95,7 @@ const float NJKFinalProgressValue = 0.9f;
 {
     _maxLoadCount = _loadingCount = 0;
     _interactive = NO;
+    _observingDocument = NO;
     [self setProgress:0.0];
 }
 
@@ -80,25 +104,50 @@ const float NJKFinalProgressValue = 0.9f;
 
 - (BOOL)webView:(UIWebView *)webView shouldStartLoadWithRequest:(NSURLRequest *)request navigationType:(UIWebViewNavigationType)navigationType
 {
-    if ([request.URL.path isEqualToString:completeRPCURLPath]) {
+    //The parts point into these strings, so they're kept alive until we're done with them
+    NS_VALID_UNTIL_END_OF_SCOPE NSString *requestURLString = request.URL.absoluteString;
+    NS_VALID_UNTIL_END_OF_SCOPE NSString *currentURLString = nil;
+    NS_VALID_UNTIL_END_OF_SCOPE NSString *mainDocumentURLString = nil;
+    
+    NJKURLParts requestParts;
+    NJKURLPartsInit(&requestParts, requestURLString);
+    
+    if (NJKURLRangeEqualsASCII(&requestParts, requestParts.path, NJK_COMPLETE_RPC_PATH, NO)) {
         [self completeProgress];
         return NO;
     }
     
+    if (NJKURLRangeEqualsASCII(&requestParts, requestParts.path, NJK_INTERACTIVE_RPC_PATH, NO)) {
+        _interactive = YES;
+        [self setProgress:NJKInteractiveProgressValue];
+        return NO;
+    }
+    
     BOOL ret = YES;
     if ([_webViewProxyDelegate respondsToSelector:@selector(webView:shouldStartLoadWithRequest:navigationType:)]) {
         ret = [_webViewProxyDelegate webView:webView shouldStartLoadWithRequest:request navigationType:navigationType];
     }
     
     BOOL isFragmentJump = NO;
-    if (request.URL.fragment) {
-        NSString *nonFragmentURL = [request.URL.absoluteString stringByReplacingOccurrencesOfString:[@"#" stringByAppendingString:request.URL.fragment] withString:@""];
-        isFragmentJump = [nonFragmentURL isEqualToString:webView.request.URL.absoluteString];
+    if (requestParts.fragment.location != kCFNotFound) {
+        currentURLString = webView.request.URL.absoluteString;
+        NJKURLParts currentParts;
+        NJKURLPartsInit(&currentParts, currentURLString);
+        isFragmentJump = NJKURLPartsAreEquivalent(&requestParts, &currentParts, YES);
     }
 
-    BOOL isTopLevelNavigation = [request.mainDocumentURL isEqual:request.URL];
+    BOOL isTopLevelNavigation = NO;
+    if (request.mainDocumentURL == request.URL) {
+        isTopLevelNavigation = YES;
+    }
+    else if (request.mainDocumentURL) {
+        mainDocumentURLString = request.mainDocumentURL.absoluteString;
+        NJKURLParts mainDocumentParts;
+        NJKURLPartsInit(&mainDocumentParts, mainDocumentURLString);
+        isTopLevelNavigation = NJKURLPartsAreEquivalent(&requestParts, &mainDocumentParts, NO);
+    }
 
-    BOOL isHTTPOrLocalFile = [request.URL.scheme isEqualToString:@"http"] || [request.URL.scheme isEqualToString:@"https"] || [request.URL.scheme isEqualToString:@"file"];
+    BOOL isHTTPOrLocalFile = (requestParts.schemeType != NJKURLSchemeOther);
     if (ret && !isFragmentJump && isHTTPOrLocalFile && isTopLevelNavigation) {
         _currentURL = request.URL;
         [self reset];
@@ -124,23 +173,7 @@ const float NJKFinalProgressValue = 0.9f;
         [_webViewProxyDelegate webViewDidFinishLoad:webView];
     }
     
-    _loadingCount--;
-    [self incrementProgress];
-    
-    NSString *readyState = [webView stringByEvaluatingJavaScriptFromString:@"document.readyState"];
-
-    BOOL interactive = [readyState isEqualToString:@"interactive"];
-    if (interactive) {
-        _interactive = YES;
-        NSString *waitForCompleteJS = [NSString stringWithFormat:@"window.addEventListener('load',function() { var iframe = document.createElement('iframe'); iframe.style.display = 'none'; iframe.src = '%@://%@%@'; document.body.appendChild(iframe);  }, false);", webView.request.mainDocumentURL.scheme, webView.request.mainDocumentURL.host, completeRPCURLPath];
-        [webView stringByEvaluatingJavaScriptFromString:waitForCompleteJS];
-    }
-    
-    BOOL isNotRedirect = _currentURL && [_currentURL isEqual:webView.request.mainDocumentURL];
-    BOOL complete = [readyState isEqualToString:@"complete"];
-    if (complete && isNotRedirect) {
-        [self completeProgress];
-    }
+    [self frameDidFinishLoadingInWebView:webView error:nil];
 }
 
 - (void)webView:(UIWebView *)webView didFailLoadWithError:(NSError *)error
@@ -149,21 +182,40 @@ const float NJKFinalProgressValue = 0.9f;
         [_webViewProxyDelegate webView:webView didFailLoadWithError:error];
     }
     
-    _loadingCount--;
-    [self incrementProgress];
-
-    NSString *readyState = [webView stringByEvaluatingJavaScriptFromString:@"document.readyState"];
+    [self frameDidFinishLoadingInWebView:webView error:error];
+}
 
-    BOOL interactive = [readyState isEqualToString:@"interactive"];
-    if (interactive) {
-        _interactive = YES;
-        NSString *waitForCompleteJS = [NSString stringWithFormat:@"window.addEventListener('load',function() { var iframe = document.createElement('iframe'); iframe.style.display = 'none'; iframe.src = '%@://%@%@'; document.body.appendChild(iframe);  }, false);", webView.request.mainDocumentURL.scheme, webView.request.mainDocumentURL.host, completeRPCURLPath];
-        [webView stringByEvaluatingJavaScriptFromString:waitForCompleteJS];
+- (void)frameDidFinishLoadingInWebView:(UIWebView *)webView error:(NSError *)error
+{
+    if (_loadingCount > 0) {
+        _loadingCount--;
     }
+    [self incrementProgress];
+    
+    if (error) {
+        if (![_progressDelegate respondsToSelector:@selector(webViewProgress:shouldCompleteProgressForError:)] ||
+            [_progressDelegate webViewProgress:self shouldCompleteProgressForError:error]) {
+            [self completeProgress];
+        }
+        return;
+    }
+    
+    // Once the document is observed, its events arrive as RPC requests, so we only
+    // need to check in again once every frame has settled.
+    if (_observingDocument && _loadingCount > 0) {
+        return;
+    }
+    
+    NSString *readyState = [webView stringByEvaluatingJavaScriptFromString:NJKDocumentObserverJS];
+    _observingDocument = YES;
     
-    BOOL isNotRedirect = _currentURL && [_currentURL isEqual:webView.request.mainDocumentURL];
     BOOL complete = [readyState isEqualToString:@"complete"];
-    if ((complete && isNotRedirect) || error) {
+    if (complete || [readyState isEqualToString:@"interactive"]) {
+        _interactive = YES;
+    }
+    
+    BOOL isNotRedirect = _currentURL && NJKURLsAreEquivalent(_currentURL, webView.request.mainDocumentURL, NO);
+    if (complete && isNotRedirect) {
         [self completeProgress];
     }
 }
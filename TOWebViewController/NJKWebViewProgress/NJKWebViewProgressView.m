@@ -65,7 +65,7 @@
             self->_progressBarView.frame = frame;
         }];
     }
-    else {
+    else if (_progressBarView.alpha < 1.0) {
         [UIView animateWithDuration:animated ? _fadeAnimationDuration : 0.0 delay:0.0 options:UIViewAnimationOptionCurveEaseInOut animations:^{
             self->_progressBarView.alpha = 1.0;
         } completion:nil];
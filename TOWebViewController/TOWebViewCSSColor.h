@@ -0,0 +1,74 @@
+//
+//  TOWebViewCSSColor.h
+//
+//  Copyright 2013-2018 Timothy Oliver. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+//  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+//  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#import <UIKit/UIKit.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/* A colour parsed from a CSS colour string, with each channel between 0.0 and 1.0 */
+typedef struct {
+    CGFloat red;
+    CGFloat green;
+    CGFloat blue;
+    CGFloat alpha;
+} TOWebViewCSSColor;
+
+/* Character helpers shared by the CSS and viewport parsers */
+static inline BOOL TOWebViewCSSIsSpace(char character)
+{
+    return (character == ' ' || character == '\t' || character == '\n' || character == '\r' || character == '\f');
+}
+
+static inline char TOWebViewCSSLowercase(char character)
+{
+    return (character >= 'A' && character <= 'Z') ? (char)(character + ('a' - 'A')) : character;
+}
+
+static inline const char *TOWebViewCSSSkipSpaces(const char *cursor)
+{
+    while (TOWebViewCSSIsSpace(*cursor)) { cursor++; }
+    return cursor;
+}
+
+/**
+ Scans a CSS number (eg '-12', '0.5', '.25', '1e2') at the cursor, independent of the current locale,
+ and advances the cursor past it.
+
+ @return NO if there isn't a number at the cursor, in which case the cursor is left where it was.
+ */
+BOOL TOWebViewCSSScanNumber(const char * _Nonnull * _Nonnull cursor, CGFloat *value);
+
+/**
+ Parses a CSS colour value in a single pass, without allocating any memory. Supports hex colours,
+ rgb()/rgba() and hsl()/hsla() in both the comma and space separated syntaxes, 'transparent',
+ and the basic colour keywords.
+
+ @return NO if the string isn't a colour that could be parsed, in which case `color` is left untouched.
+ */
+BOOL TOWebViewParseCSSColor(const char * _Nullable string, TOWebViewCSSColor *color);
+
+/**
+ Parses a CSS colour value into a `UIColor`, or returns nil if it isn't a colour that could be parsed.
+ */
+UIColor * _Nullable TOWebViewColorFromCSSString(NSString * _Nullable string);
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,297 @@
+//
+//  TOWebViewCSSColor.m
+//
+//  Copyright 2013-2018 Timothy Oliver. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+//  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+//  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#import "TOWebViewCSSColor.h"
+
+typedef struct {
+    const char *name;
+    uint32_t rgb;
+} TOWebViewCSSNamedColor;
+
+/* The basic CSS colour keywords. (Computed styles are always returned as rgb()/rgba(), so these are rarely seen) */
+static const TOWebViewCSSNamedColor TOWebViewCSSNamedColors[] = {
+    {"black", 0x000000}, {"silver", 0xc0c0c0}, {"gray", 0x808080}, {"grey", 0x808080},
+    {"white", 0xffffff}, {"maroon", 0x800000}, {"red", 0xff0000}, {"purple", 0x800080},
+    {"fuchsia", 0xff00ff}, {"green", 0x008000}, {"lime", 0x00ff00}, {"olive", 0x808000},
+    {"yellow", 0xffff00}, {"navy", 0x000080}, {"blue", 0x0000ff}, {"teal", 0x008080},
+    {"aqua", 0x00ffff}, {"orange", 0xffa500}
+};
+
+static inline CGFloat TOWebViewCSSClamp(CGFloat value)
+{
+    return MIN(MAX(value, 0.0f), 1.0f);
+}
+
+/* Case-insensitively matches `keyword` at the cursor, and advances past it */
+static BOOL TOWebViewCSSScanKeyword(const char **cursor, const char *keyword)
+{
+    const char *position = *cursor;
+    while (*keyword) {
+        if (TOWebViewCSSLowercase(*position) != *keyword) { return NO; }
+        position++;
+        keyword++;
+    }
+    
+    *cursor = position;
+    return YES;
+}
+
+BOOL TOWebViewCSSScanNumber(const char **cursor, CGFloat *value)
+{
+    const char *position = *cursor;
+    CGFloat sign = 1.0f;
+    if (*position == '+' || *position == '-') {
+        sign = (*position == '-') ? -1.0f : 1.0f;
+        position++;
+    }
+    
+    double number = 0.0;
+    BOOL hasDigits = NO;
+    while (*position >= '0' && *position <= '9') {
+        number = (number * 10.0) + (*position - '0');
+        hasDigits = YES;
+        position++;
+    }
+    
+    if (*position == '.') {
+        position++;
+        double divisor = 10.0;
+        while (*position >= '0' && *position <= '9') {
+            number += (*position - '0') / divisor;
+            divisor *= 10.0;
+            hasDigits = YES;
+            position++;
+        }
+    }
+    
+    if (!hasDigits) { return NO; }
+    
+    if ((*position == 'e' || *position == 'E') &&
+        ((position[1] >= '0' && position[1] <= '9') ||
+         ((position[1] == '+' || position[1] == '-') && position[2] >= '0' && position[2] <= '9')))
+    {
+        position++;
+        NSInteger exponentSign = 1;
+        if (*position == '+' || *position == '-') {
+            exponentSign = (*position == '-') ? -1 : 1;
+            position++;
+        }
+        
+        NSInteger exponent = 0;
+        while (*position >= '0' && *position <= '9') {
+            exponent = MIN((exponent * 10) + (*position - '0'), 99);
+            position++;
+        }
+        
+        for (NSInteger i = 0; i < exponent; i++) {
+            number = (exponentSign > 0) ? (number * 10.0) : (number / 10.0);
+        }
+    }
+    
+    *value = (CGFloat)(number * sign);
+    *cursor = position;
+    return YES;
+}
+
+static NSInteger TOWebViewCSSHexValue(char character)
+{
+    if (character >= '0' && character <= '9') { return character - '0'; }
+    character = TOWebViewCSSLowercase(character);
+    if (character >= 'a' && character <= 'f') { return 10 + (character - 'a'); }
+    return -1;
+}
+
+static BOOL TOWebViewCSSParseHexColor(const char *cursor, TOWebViewCSSColor *color)
+{
+    NSInteger digits[8];
+    NSInteger count = 0;
+    while (count < 8 && TOWebViewCSSHexValue(cursor[count]) >= 0) {
+        digits[count] = TOWebViewCSSHexValue(cursor[count]);
+        count++;
+    }
+    
+    if (*TOWebViewCSSSkipSpaces(cursor + count) != '\0') { return NO; }
+    
+    CGFloat channels[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+    if (count == 3 || count == 4) { // #rgb, #rgba
+        for (NSInteger i = 0; i < count; i++) {
+            channels[i] = (CGFloat)(digits[i] * 17) / 255.0f;
+        }
+    }
+    else if (count == 6 || count == 8) { // #rrggbb, #rrggbbaa
+        for (NSInteger i = 0; i < count / 2; i++) {
+            channels[i] = (CGFloat)((digits[i * 2] * 16) + digits[(i * 2) + 1]) / 255.0f;
+        }
+    }
+    else {
+        return NO;
+    }
+    
+    *color = (TOWebViewCSSColor){channels[0], channels[1], channels[2], channels[3]};
+    return YES;
+}
+
+static CGFloat TOWebViewCSSHueToRGB(CGFloat p, CGFloat q, CGFloat t)
+{
+    if (t < 0.0f) { t += 1.0f; }
+    if (t > 1.0f) { t -= 1.0f; }
+    if (t < 1.0f / 6.0f) { return p + (q - p) * 6.0f * t; }
+    if (t < 1.0f / 2.0f) { return q; }
+    if (t < 2.0f / 3.0f) { return p + (q - p) * (2.0f / 3.0f - t) * 6.0f; }
+    return p;
+}
+
+/*
+ Parses the arguments of rgb(), rgba(), hsl() and hsla(), in both the legacy comma separated
+ syntax, and the space separated syntax with an optional '/ alpha' component.
+ */
+static BOOL TOWebViewCSSParseColorFunction(const char *cursor, BOOL isHSL, TOWebViewCSSColor *color)
+{
+    CGFloat values[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+    NSInteger count = 0;
+    BOOL commaSeparated = NO;
+    
+    cursor = TOWebViewCSSSkipSpaces(cursor);
+    while (*cursor != ')') {
+        if (count == 4) { return NO; }
+        
+        //Work out the separator before each argument after the first
+        if (count > 0) {
+            BOOL hasSpace = TOWebViewCSSIsSpace(*(cursor - 1));
+            if (*cursor == ',') {
+                if (count == 1) { commaSeparated = YES; }
+                else if (!commaSeparated) { return NO; }
+                cursor = TOWebViewCSSSkipSpaces(cursor + 1);
+            }
+            else if (*cursor == '/') {
+                if (commaSeparated || count != 3) { return NO; }
+                cursor = TOWebViewCSSSkipSpaces(cursor + 1);
+            }
+            else if (!hasSpace || commaSeparated || count == 3) {
+                return NO;
+            }
+        }
+        
+        CGFloat value = 0.0f;
+        if (!TOWebViewCSSScanNumber(&cursor, &value)) { return NO; }
+        
+        BOOL isPercentage = NO;
+        if (*cursor == '%') {
+            isPercentage = YES;
+            cursor++;
+        }
+        else if (isHSL && count == 0) {
+            if (TOWebViewCSSScanKeyword(&cursor, "deg")) { }
+            else if (TOWebViewCSSScanKeyword(&cursor, "grad")) { value *= 0.9f; }
+            else if (TOWebViewCSSScanKeyword(&cursor, "rad")) { value *= (CGFloat)(180.0 / M_PI); }
+            else if (TOWebViewCSSScanKeyword(&cursor, "turn")) { value *= 360.0f; }
+        }
+        
+        //Normalize each component to a 0.0 - 1.0 range (hue is kept in degrees for now)
+        if (count == 3) {
+            value = isPercentage ? value / 100.0f : value;
+        }
+        else if (isHSL) {
+            if (count > 0 && !isPercentage) { return NO; }
+            value = (count == 0) ? value : value / 100.0f;
+        }
+        else {
+            value = isPercentage ? value / 100.0f : value / 255.0f;
+        }
+        
+        values[count++] = value;
+        cursor = TOWebViewCSSSkipSpaces(cursor);
+        if (*cursor == '\0') { return NO; }
+    }
+    
+    if (count < 3 || *TOWebViewCSSSkipSpaces(cursor + 1) != '\0') {
+        return NO;
+    }
+    
+    if (isHSL) {
+        CGFloat hue = fmod(values[0], 360.0f) / 360.0f;
+        if (hue < 0.0f) { hue += 1.0f; }
+        CGFloat saturation = TOWebViewCSSClamp(values[1]);
+        CGFloat lightness = TOWebViewCSSClamp(values[2]);
+        
+        CGFloat q = (lightness < 0.5f) ? lightness * (1.0f + saturation) : lightness + saturation - (lightness * saturation);
+        CGFloat p = (2.0f * lightness) - q;
+        values[0] = TOWebViewCSSHueToRGB(p, q, hue + (1.0f / 3.0f));
+        values[1] = TOWebViewCSSHueToRGB(p, q, hue);
+        values[2] = TOWebViewCSSHueToRGB(p, q, hue - (1.0f / 3.0f));
+    }
+    
+    *color = (TOWebViewCSSColor){TOWebViewCSSClamp(values[0]), TOWebViewCSSClamp(values[1]),
+                                 TOWebViewCSSClamp(values[2]), TOWebViewCSSClamp(values[3])};
+    return YES;
+}
+
+BOOL TOWebViewParseCSSColor(const char *string, TOWebViewCSSColor *color)
+{
+    if (string == NULL) { return NO; }
+    
+    const char *cursor = TOWebViewCSSSkipSpaces(string);
+    
+    if (*cursor == '#') {
+        return TOWebViewCSSParseHexColor(cursor + 1, color);
+    }
+    
+    if (TOWebViewCSSScanKeyword(&cursor, "rgba(") || TOWebViewCSSScanKeyword(&cursor, "rgb(")) {
+        return TOWebViewCSSParseColorFunction(cursor, NO, color);
+    }
+    
+    if (TOWebViewCSSScanKeyword(&cursor, "hsla(") || TOWebViewCSSScanKeyword(&cursor, "hsl(")) {
+        return TOWebViewCSSParseColorFunction(cursor, YES, color);
+    }
+    
+    const char *keyword = cursor;
+    if (TOWebViewCSSScanKeyword(&keyword, "transparent") && *TOWebViewCSSSkipSpaces(keyword) == '\0') {
+        *color = (TOWebViewCSSColor){0.0f, 0.0f, 0.0f, 0.0f};
+        return YES;
+    }
+    
+    for (size_t i = 0; i < sizeof(TOWebViewCSSNamedColors) / sizeof(TOWebViewCSSNamedColor); i++) {
+        keyword = cursor;
+        if (TOWebViewCSSScanKeyword(&keyword, TOWebViewCSSNamedColors[i].name) && *TOWebViewCSSSkipSpaces(keyword) == '\0') {
+            uint32_t rgb = TOWebViewCSSNamedColors[i].rgb;
+            *color = (TOWebViewCSSColor){((rgb >> 16) & 0xff) / 255.0f, ((rgb >> 8) & 0xff) / 255.0f, (rgb & 0xff) / 255.0f, 1.0f};
+            return YES;
+        }
+    }
+    
+    return NO;
+}
+
+UIColor *TOWebViewColorFromCSSString(NSString *string)
+{
+    //Copy the string into a stack buffer, and parse it from there
+    char colorString[128];
+    TOWebViewCSSColor color;
+    if (string.length == 0 ||
+        [string getCString:colorString maxLength:sizeof(colorString) encoding:NSASCIIStringEncoding] == NO ||
+        TOWebViewParseCSSColor(colorString, &color) == NO)
+    {
+        return nil;
+    }
+    
+    return [UIColor colorWithRed:color.red green:color.green blue:color.blue alpha:color.alpha];
+}
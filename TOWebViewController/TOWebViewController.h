@@ -24,6 +24,30 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+/* Keys for the page load metrics passed to `pageLoadMetricsHandler` */
+extern NSString * const TOWebViewPageLoadMetricsURLKey;                  /* NSURL of the page that was loaded */
+extern NSString * const TOWebViewPageLoadMetricsStartLoadIntervalKey;    /* Seconds from the request until the web view started loading */
+extern NSString * const TOWebViewPageLoadMetricsInteractiveIntervalKey;  /* Seconds from the request until the page became interactive */
+extern NSString * const TOWebViewPageLoadMetricsCompleteIntervalKey;     /* Seconds from the request until loading finished (Omitted if the page failed) */
+extern NSString * const TOWebViewPageLoadMetricsScriptCallCountKey;      /* Number of JavaScript calls the controller made into the page */
+extern NSString * const TOWebViewPageLoadMetricsScriptDurationKey;       /* Total seconds the main thread spent blocked on those calls */
+extern NSString * const TOWebViewPageLoadMetricsErrorKey;                /* NSError the page failed to load with (Only present if it failed) */
+
+/* Keys for the estimates returned by `estimatedMemoryFootprint`, each an NSNumber of bytes */
+extern NSString * const TOWebViewMemoryFootprintWebViewKey;             /* The web view's rendered content, at screen resolution */
+extern NSString * const TOWebViewMemoryFootprintRotationSnapshotKey;    /* The snapshot shown while rotating, if one is being shown */
+extern NSString * const TOWebViewMemoryFootprintIconsKey;               /* The navigation button icons (These are shared between controllers) */
+extern NSString * const TOWebViewMemoryFootprintReaderModeKey;          /* The extracted article text, while reader mode is enabled */
+extern NSString * const TOWebViewMemoryFootprintGradientKey;            /* The shadow gradient shown behind the web view, if it's visible */
+extern NSString * const TOWebViewMemoryFootprintApplicationButtonsKey;  /* The images of any application bar button items (eg, the 1Password button) */
+extern NSString * const TOWebViewMemoryFootprintTotalKey;               /* The sum of all of the above */
+
+/* The point in a page's loading that a user script is run */
+typedef NS_ENUM(NSInteger, TOWebViewUserScriptInjectionTime) {
+    TOWebViewUserScriptInjectionTimeInteractive,    /* Once the document has been parsed and its body is available */
+    TOWebViewUserScriptInjectionTimeComplete        /* Once the document and all of its resources have finished loading */
+};
+
 @interface TOWebViewController : UIViewController <UIWebViewDelegate>
 
 /**
@@ -44,6 +68,93 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (instancetype)initWithURLString:(NSString *)urlString;
 
+/**
+ Renders the navigation button and activity icons on a background queue ahead of time,
+ so the first controller to appear doesn't need to draw them on the main thread.
+ 
+ Call this early on, for example once the app has finished launching.
+ */
++ (void)prepareIcons;
+
+/**
+ Creates a small number of web views ahead of time, which new controllers will take
+ instead of creating their own. The first web view created also starts up WebKit,
+ which is the bulk of the delay before a page can start loading.
+ 
+ The prepared web views are released if the app receives a memory warning.
+ Must be called on the main thread.
+ 
+ @param count The number of web views to keep prepared (up to a maximum of 3).
+ */
++ (void)prepareWebViews:(NSUInteger)count;
+
+/**
+ Forgets every host that controllers have seen redirecting from HTTP to HTTPS (see `learnsHTTPSRedirects`).
+ */
++ (void)resetLearnedHTTPSHosts;
+
+/**
+ Creates the web view and starts loading the page at `url` before the controller
+ has been presented. Call this just ahead of pushing or presenting the controller,
+ so the page is already on its way by the time it appears.
+ 
+ Releasing the controller without presenting it cancels the load.
+ */
+- (void)preload;
+
+/**
+ Highlights every occurrence of the specified text in the current page, ignoring case, and scrolls
+ to the first one if it isn't already visible. Any previous highlights are removed.
+ 
+ The page's text is indexed on the first search, and a search that extends the previous one (such as
+ when the user is typing) only needs to check the previous matches, so this is fast to call on each keystroke.
+ 
+ @param string The text to search for. Passing an empty string removes all highlights.
+ 
+ @return The number of occurrences found.
+ */
+- (NSUInteger)highlightOccurrencesOfString:(NSString *)string;
+
+/**
+ Removes any highlights added by `highlightOccurrencesOfString:`.
+ */
+- (void)removeHighlights;
+
+/**
+ An estimate of the memory held by this controller, broken down by category (see the
+ `TOWebViewMemoryFootprint` keys above). This is computed from the sizes of the views and images the
+ controller currently holds, so it's cheap enough to sample periodically, and is useful for comparing
+ builds, rather than as an exact measurement.
+ 
+ In debug builds, a warning is also logged if a controller is still alive a few seconds after it
+ has been dismissed, which usually means something is retaining it (see `reportsLeaksAfterDismissal`).
+ */
+@property (nonatomic, readonly) NSDictionary<NSString *, NSNumber *> *estimatedMemoryFootprint;
+
+/**
+ In debug builds, whether a warning is logged if this controller is still alive a few seconds after
+ being popped or dismissed. Set this to NO for controllers the app deliberately keeps around to be
+ shown again later.
+ 
+ Default value is YES.
+ */
+@property (nonatomic, assign) BOOL reportsLeaksAfterDismissal;
+
+/**
+ Adds a script that will be run in every page the controller loads, exactly once per page.
+ Scripts for the same injection time are run in the order they were added, in a single
+ JavaScript call. Each script runs in its own function scope, in the main frame only.
+ 
+ @param source The JavaScript source of the script.
+ @param injectionTime The point in the page's loading that the script should be run.
+ */
+- (void)addUserScript:(NSString *)source injectionTime:(TOWebViewUserScriptInjectionTime)injectionTime;
+
+/**
+ Removes all of the scripts added with `addUserScript:injectionTime:`.
+ */
+- (void)removeAllUserScripts;
+
 /** 
  Get/set the current URL being displayed. (Will automatically start loading) 
  */
@@ -144,7 +255,9 @@ NS_ASSUME_NONNULL_BEGIN
 @property (nonatomic, assign)    BOOL showPageTitles;
 
 /**
- View controller's title property will be set to the page's host. www prefix will be stripped
+ View controller's title property will be set to the page's host, shortened to its registrable domain.
+ (eg, 'www.apple.com' is shown as 'apple.com', and 'news.bbc.co.uk' as 'bbc.co.uk', while 'evil.github.io'
+ is shown in full, since anyone can register a name under 'github.io')
  
  Default value is NO.
  */
@@ -165,6 +278,37 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic, assign)    BOOL hideWebViewBoundaries;
 
+/**
+ When a page fails to load because the device is offline, tries loading the copy of that page
+ stored in the app's shared URL cache instead. If there isn't one, the original error is reported
+ to `didFailLoadWithErrorRequestHandler` as normal.
+ 
+ Default value is NO.
+ */
+@property (nonatomic, assign)    BOOL loadsFromCacheWhenOffline;
+
+/**
+ Shows the main article text of the current page in a plain, native text view in place of the
+ web view. The text is extracted from the page in a single JavaScript call.
+ 
+ If no article text can be found on the page, this property will remain NO.
+ Reader mode is turned off again whenever a new page starts loading.
+ */
+@property (nonatomic, assign)    BOOL readerModeEnabled;
+
+/**
+ When the app receives a memory warning while this controller is hidden (eg, covered by another
+ controller pushed on top of it), releases the web view, and reloads the page from its URL once the
+ controller reappears.
+ 
+ The page's back/forward history, form contents and script state are lost when this happens, so
+ it is best suited to controllers showing simple pages. The web view is never released while the
+ controller is presenting another controller, or when the page was the result of a form submission.
+ 
+ Default value is NO.
+ */
+@property (nonatomic, assign)    BOOL unloadsWebViewWhenHidden;
+
 /** 
  When the view controller is being presented as a modal popup, this block will be automatically performed
  right after the view controller is dismissed.
@@ -177,6 +321,44 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic, copy, nullable)      BOOL (^shouldStartLoadRequestHandler)(NSURLRequest *request, UIWebViewNavigationType navigationType);
 
+/**
+ An optional list of host names that pages and frames will be blocked from loading, such as
+ ad servers that open their own pages. Subdomains of each host are blocked as well (eg,
+ 'example.com' will also block 'ads.example.com').
+ 
+ Only page and frame loads can be blocked, as those are the only requests UIWebView asks its
+ delegate about. Scripts, images and XHR requests made by a page still load from these hosts.
+ 
+ The list is compiled into a lookup set when assigned, so large lists stay fast to check
+ against each request. Blocked requests never reach `shouldStartLoadRequestHandler`.
+ 
+ Default value is nil.
+ */
+@property (nonatomic, copy, nullable)      NSArray *blockedRequestHosts;
+
+/**
+ An optional list of host names that are known to only be served over HTTPS. URLs set on the
+ controller for these hosts (or their subdomains) are loaded over HTTPS straight away, rather
+ than waiting for the site to redirect there.
+ 
+ Hosts learned by controllers with `learnsHTTPSRedirects` enabled are upgraded as well.
+ 
+ Default value is nil.
+ */
+@property (nonatomic, copy, nullable)      NSArray *httpsUpgradeHosts;
+
+/**
+ When enabled, hosts that this controller sees redirecting from HTTP to HTTPS are remembered, and
+ URLs for them are loaded over HTTPS straight away from then on, by any controller.
+ 
+ Learned hosts are only kept in memory, and are forgotten when the app quits, after 30 days, or
+ sooner once 512 other hosts have been seen more recently. Call `resetLearnedHTTPSHosts` to forget
+ all of them.
+ 
+ Default value is NO.
+ */
+@property (nonatomic, assign)              BOOL learnsHTTPSRedirects;
+
 /**
  An optional block that when set, will be triggered if the web view failed to load a frame.
  */
@@ -187,6 +369,19 @@ An optional block that when set, will be triggered each time the web view has fi
 */
 @property (nonatomic, copy, nullable)      void (^didFinishLoadHandler)(UIWebView *webView);
 
+/**
+ An optional block that when set, will be triggered once each page has finished loading, with a
+ dictionary of timings for that page load (see the `TOWebViewPageLoadMetrics` keys above).
+ 
+ Intervals are measured from when the request was started, and are omitted for any stage the page
+ never reached (eg, the interactive interval of a page that failed to load). A page that failed to
+ load is reported with its error instead of a complete interval.
+ 
+ The script counts only cover the controller's own calls into the page; the ones made by the progress
+ tracker to watch the document's ready state aren't included.
+ */
+@property (nonatomic, copy, nullable)      void (^pageLoadMetricsHandler)(NSDictionary<NSString *, id> *metrics);
+
 /** 
  This can be used to override the default tint color of the navigation button icons.
  This property is mainly for iOS 6 and lower. Where possible, you should use iOS 7's proper color styling
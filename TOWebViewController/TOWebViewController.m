@@ -24,6 +24,9 @@
 #import "TOActivitySafari.h"
 #import "TOActivityChrome.h"
 #import "UIImage+TOWebViewControllerIcons.h"
+#import "TOWebViewCSSColor.h"
+#import "TOWebViewViewport.h"
+#import "TOWebViewPublicSuffix.h"
 
 #import "NJKWebViewProgress.h"
 #import "NJKWebViewProgressView.h"
@@ -58,6 +61,104 @@
 /* Hieght of the loading progress bar view */
 #define LOADING_BAR_HEIGHT ((CGFloat)2.f)        
 
+/* Keys for the state saved and restored by UIKit state restoration */
+#define RESTORATION_STATE_VERSION           1
+#define RESTORATION_VERSION_KEY             @"TOWebViewControllerRestorationVersion"
+#define RESTORATION_URL_KEY                 @"TOWebViewControllerRestorationURL"
+#define RESTORATION_TITLE_KEY               @"TOWebViewControllerRestorationTitle"
+#define RESTORATION_CONTENT_OFFSET_KEY      @"TOWebViewControllerRestorationContentOffset"
+#define RESTORATION_ZOOM_SCALE_KEY          @"TOWebViewControllerRestorationZoomScale"
+
+/* Hosts seen redirecting from HTTP to HTTPS, saved across app launches along with when they were last seen */
+#define HTTPS_UPGRADE_LEARNED_HOSTS_MAX_COUNT   512
+#define HTTPS_UPGRADE_LEARNED_HOST_LIFETIME     (60.0 * 60.0 * 24.0 * 30.0)
+
+/* How long after being dismissed a controller should have been released by, before a leak is reported (Debug only) */
+#define DISMISSED_LEAK_CHECK_DELAY      3.0
+
+/* The maximum number of web views kept prepared by `prepareWebViews:` */
+#define WEB_VIEW_POOL_MAX_COUNT         3
+
+/* Rotation snapshot resolution limits */
+#define ROTATION_SNAPSHOT_MAX_SCALE     1.75f
+#define ROTATION_SNAPSHOT_MAX_PIXELS    (2048.0f * 2048.0f)
+
+/* Fetches the computed background colour of the page body */
+#define PAGE_BACKGROUND_COLOR_SCRIPT @"window.getComputedStyle(document.body,null).getPropertyValue('background-color');"
+
+/* Page state snapshot, captured in a single JavaScript call as fields separated by the ASCII unit separator */
+#define PAGE_STATE_VERSION      @"2"
+#define PAGE_STATE_SEPARATOR    @"\x1f"
+#define PAGE_STATE_SCRIPT \
+            @"(function(){var d=document,s=String.fromCharCode(31),r=d.readyState,c='',v='';" \
+            @"if(d.body&&(r=='interactive'||r=='complete')){" \
+            @"c=window.getComputedStyle(d.body,null).getPropertyValue('background-color');" \
+            @"var m=d.querySelector('meta[name=viewport]');v=m?(m.getAttribute('content')||''):'';}" \
+            @"return ['" PAGE_STATE_VERSION @"',r,d.title,window.location.hostname,c,v]" \
+            @".map(function(v){return String(v).split(s).join('');}).join(s);})()"
+
+/* Disables the popup shown when tapping and holding on a link (Registered as a user script when `disableContextualPopupMenu` is set) */
+#define DISABLE_CONTEXTUAL_POPUP_SCRIPT @"if(document.body){document.body.style.webkitTouchCallout='none';}"
+
+/* Finds the element with the densest run of paragraph text, and returns its text blocks as JSON (or '' if there isn't one) */
+#define READER_CONTENT_SCRIPT \
+            @"(function(){var d=document,r=/^(P|LI|BLOCKQUOTE|PRE)$/;if(!d.body){return '';}" \
+            @"var ps=d.getElementsByTagName('p'),c=[],s=[],i,j,n,t;" \
+            @"for(i=0;i<ps.length;i++){t=(ps[i].textContent||'').replace(/\\s+/g,' ').trim();if(t.length<25){continue;}" \
+            @"var w=1+Math.min(3,Math.floor(t.length/100))+t.split(',').length;n=ps[i].parentNode;" \
+            @"for(j=0;j<2&&n&&n.nodeType==1;j++){var k=c.indexOf(n);if(k<0){k=c.length;c.push(n);s.push(0);}s[k]+=(j?w/2:w);n=n.parentNode;}}" \
+            @"var b=null,bs=0;for(i=0;i<c.length;i++){var l=(c[i].textContent||'').length,a=0,as=c[i].getElementsByTagName('a');" \
+            @"for(j=0;j<as.length;j++){a+=(as[j].textContent||'').length;}var v=s[i]*(1-(l?a/l:0));if(v>bs){bs=v;b=c[i];}}" \
+            @"if(!b){return '';}" \
+            @"var e=b.querySelectorAll('h1,h2,h3,h4,p,li,blockquote,pre'),o=[];" \
+            @"for(i=0;i<e.length;i++){for(n=e[i].parentNode;n&&n!=b&&!r.test(n.tagName);n=n.parentNode){}if(n!=b){continue;}" \
+            @"t=(e[i].textContent||'').replace(/\\s+/g,' ').trim();if(t.length){o.push([e[i].tagName.toLowerCase(),t]);}}" \
+            @"return JSON.stringify({title:d.title,blocks:o});})()"
+
+/* Highlights case-insensitive matches of a query in the page, returning the number of matches.
+   The page text is indexed once per document (and again only if the DOM changes), and a query
+   that extends the previous one only rechecks the previous match positions. */
+#define FIND_IN_PAGE_SCRIPT \
+            @"(function(q){var w=window,d=document,f=w.__toFind,i,j,n;if(!d.body){return 0;}" \
+            @"if(!f){f=w.__toFind={dirty:true,query:'',positions:[]};if(w.MutationObserver){new w.MutationObserver(function(){f.dirty=true;}).observe(d.body,{childList:true,subtree:true,characterData:true});}}" \
+            @"if(f.box&&f.box.parentNode){f.box.parentNode.removeChild(f.box);}f.box=null;" \
+            @"q=q.toLowerCase();if(!q.length){f.query='';f.positions=[];return 0;}" \
+            @"var rebuilt=f.dirty||!w.MutationObserver;" \
+            @"if(rebuilt){var t=d.createTreeWalker(d.body,4,null,false),s=[],o=0;f.nodes=[];f.starts=[];" \
+            @"while((n=t.nextNode())){var p=n.parentNode.nodeName,v=n.nodeValue,l=v.toLowerCase();if(!v.length||p=='SCRIPT'||p=='STYLE'||p=='NOSCRIPT'){continue;}" \
+            @"f.nodes.push(n);f.starts.push(o);s.push(l.length==v.length?l:v);o+=v.length;}" \
+            @"f.text=s.join('');f.dirty=false;}" \
+            @"var c=[];if(!rebuilt&&f.query.length&&q.indexOf(f.query)==0){for(i=0;i<f.positions.length;i++){if(f.text.substr(f.positions[i],q.length)==q){c.push(f.positions[i]);}}}" \
+            @"else{for(i=f.text.indexOf(q);i>=0;i=f.text.indexOf(q,i+1)){c.push(i);}}" \
+            @"f.query=q;f.positions=c;" \
+            @"var m=[],end=-1;for(i=0;i<c.length;i++){if(c[i]>=end){m.push(c[i]);end=c[i]+q.length;}}" \
+            @"var locate=function(x){var lo=0,hi=f.starts.length-1;while(lo<hi){var mid=(lo+hi+1)>>1;if(f.starts[mid]<=x){lo=mid;}else{hi=mid-1;}}return lo;};" \
+            @"var b=d.createElement('div'),sx=w.pageXOffset,sy=w.pageYOffset,first=null;b.style.cssText='position:absolute;left:0;top:0;pointer-events:none;z-index:2147483647;';" \
+            @"for(i=0;i<m.length&&i<500;i++){var a=locate(m[i]),e=locate(m[i]+q.length-1),r=d.createRange();" \
+            @"r.setStart(f.nodes[a],m[i]-f.starts[a]);r.setEnd(f.nodes[e],m[i]+q.length-f.starts[e]);" \
+            @"var rs=r.getClientRects();for(j=0;j<rs.length;j++){var h=d.createElement('div');" \
+            @"h.style.cssText='position:absolute;border-radius:2px;background:'+(i?'rgba(255,235,0,0.45)':'rgba(255,150,0,0.6)')+';left:'+(rs[j].left+sx)+'px;top:'+(rs[j].top+sy)+'px;width:'+rs[j].width+'px;height:'+rs[j].height+'px;';" \
+            @"b.appendChild(h);if(first===null){first=rs[j].top+sy;}}}" \
+            @"d.documentElement.appendChild(b);f.box=b;" \
+            @"if(first!==null&&(first<sy||first>sy+w.innerHeight-40)){w.scrollTo(sx,Math.max(0,first-w.innerHeight/3));}" \
+            @"return m.length;})"
+
+NSString * const TOWebViewPageLoadMetricsURLKey                 = @"url";
+NSString * const TOWebViewPageLoadMetricsStartLoadIntervalKey   = @"startLoadInterval";
+NSString * const TOWebViewPageLoadMetricsInteractiveIntervalKey = @"interactiveInterval";
+NSString * const TOWebViewPageLoadMetricsCompleteIntervalKey    = @"completeInterval";
+NSString * const TOWebViewPageLoadMetricsScriptCallCountKey     = @"scriptCallCount";
+NSString * const TOWebViewPageLoadMetricsScriptDurationKey      = @"scriptDuration";
+NSString * const TOWebViewPageLoadMetricsErrorKey               = @"error";
+
+NSString * const TOWebViewMemoryFootprintWebViewKey           = @"webView";
+NSString * const TOWebViewMemoryFootprintRotationSnapshotKey  = @"rotationSnapshot";
+NSString * const TOWebViewMemoryFootprintIconsKey             = @"icons";
+NSString * const TOWebViewMemoryFootprintReaderModeKey        = @"readerMode";
+NSString * const TOWebViewMemoryFootprintGradientKey          = @"gradient";
+NSString * const TOWebViewMemoryFootprintApplicationButtonsKey = @"applicationButtons";
+NSString * const TOWebViewMemoryFootprintTotalKey             = @"total";
+
 #pragma mark -
 #pragma mark Hidden Properties/Methods
 @interface TOWebViewController () <UIActionSheetDelegate,
@@ -79,6 +180,17 @@
         CGFloat    topEdgeInset;
         CGFloat    bottomEdgeInset;
     } _webViewState;
+    
+    //Timings of the current page load, as media times (0 when that stage hasn't been reached yet)
+    struct {
+        CFTimeInterval pendingRequestTime;  /* A top-level request that hasn't reset the progress yet */
+        CFTimeInterval requestTime;
+        CFTimeInterval startLoadTime;
+        CFTimeInterval interactiveTime;
+        NSUInteger     scriptCallCount;
+        CFTimeInterval scriptDuration;
+        BOOL           reported;
+    } _loadMetrics;
 }
 
 /* View controller presentation state tracking */
@@ -110,6 +222,56 @@
 @property (nonatomic,strong) UIImage *reloadIcon;
 @property (nonatomic,strong) UIImage *stopIcon;
 
+/* The state of the current page, captured from the web view in one JavaScript call */
+@property (nonatomic, copy) NSString *pageReadyState;
+@property (nonatomic, copy) NSString *pageTitle;
+@property (nonatomic, copy) NSString *pageHost;
+@property (nonatomic, copy) NSString *pageBackgroundColorString;
+@property (nonatomic, copy) NSString *pageViewportContent;
+@property (nonatomic, assign) BOOL pageViewportParsed;               /* The viewport content has been parsed, and pageWidthIsDynamic is valid */
+@property (nonatomic, assign) BOOL pageWidthIsDynamic;
+@property (nonatomic, assign) BOOL pageStateComplete;                 /* The page has finished loading, so the state won't change until the next navigation */
+
+/* The last host name passed to shortenHostname:, and its result */
+@property (nonatomic, copy) NSString *shortenedHostnameSource;
+@property (nonatomic, copy) NSString *shortenedHostname;
+
+/* The most recent top-level page request, and whether it is being retried from the offline cache */
+@property (nonatomic, strong) NSURL *pageRequestURL;
+@property (nonatomic, strong) NSError *offlineCacheFallbackError;   /* The error that caused the retry, reported if the retry fails as well */
+@property (nonatomic, strong) NSError *loadMetricsError;            /* The error that stopped the current page from loading, if it failed */
+@property (nonatomic, assign) BOOL loadingFromOfflineCache;         /* The retry has been requested, but hasn't reached the delegate yet */
+
+/* State decoded by state restoration, shown until the restored page has loaded */
+@property (nonatomic, strong) NSValue *restoredContentOffset;
+@property (nonatomic, assign) CGFloat restoredZoomScale;
+@property (nonatomic, copy) NSString *restoredTitle;
+
+/* Scripts registered with `addUserScript:injectionTime:`, and the combined script for each injection time */
+@property (nonatomic, strong) NSMutableArray *userScripts;
+@property (nonatomic, copy) NSArray *userScriptPayloads;
+/* The injection times whose user scripts have been run in the current document (one bit per injection time) */
+@property (nonatomic, assign) NSUInteger injectedUserScriptTimes;
+
+/* The inputs the bar buttons were last laid out for (See `currentButtonLayoutKey`) */
+@property (nonatomic, copy) NSArray *buttonLayoutKey;
+
+/* A button state update has been scheduled for the next pass of the run loop */
+@property (nonatomic, assign) BOOL buttonsStateRefreshPending;
+/* Whether we last told the status bar to show the network activity indicator */
+@property (nonatomic, assign) BOOL showingNetworkActivityIndicator;
+
+/* Displays the page's article text while reader mode is enabled */
+@property (nonatomic, strong) UITextView *readerTextView;
+
+/* The compiled set of lowercase host names from `blockedRequestHosts` */
+@property (nonatomic,strong) NSSet *blockedRequestHostSet;
+
+/* The compiled set of lowercase host names from `httpsUpgradeHosts` */
+@property (nonatomic,strong) NSSet *httpsUpgradeHostSet;
+/* The host of the last page request, if it was made over plain HTTP */
+@property (nonatomic,copy) NSString *insecurePageRequestHost;
+
 /* Theming attributes for generating navigation button art. */
 @property (nonatomic,strong) NSMutableDictionary *buttonThemeAttributes;
 
@@ -130,11 +292,27 @@
 @property (nonatomic,assign) BOOL capturedNavigationControllerState;
 /* First time the view controller has been loaded. */
 @property (nonatomic, assign) BOOL initialLoad;
+/* The initial page was already requested by `preload`, so it doesn't need to be requested when the view appears. */
+@property (nonatomic, assign) BOOL initialRequestPreloaded;
 
 @end
 
 // -------------------------------------------------------
 
+#pragma mark - Memory Estimates -
+
+/* The number of bytes a decoded image occupies in memory */
+static NSUInteger TOWebViewImageByteCount(UIImage *image)
+{
+    CGImageRef imageRef = image.CGImage;
+    if (imageRef == NULL)
+        return 0;
+    
+    return CGImageGetBytesPerRow(imageRef) * CGImageGetHeight(imageRef);
+}
+
+// -------------------------------------------------------
+
 #pragma mark - Class Implementation -
 @implementation TOWebViewController
 
@@ -168,18 +346,157 @@
     return [self initWithURL:[NSURL URLWithString:urlString]];
 }
 
++ (void)prepareIcons
+{
+    [UIImage TOWebViewControllerIcon_prepareIconsWithAttributes:nil];
+    
+    //The activity icons are drawn once per app session, so render them now as well
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        [[TOActivitySafari new] activityImage];
+        [[TOActivityChrome new] activityImage];
+    });
+}
+
+#pragma mark - HTTPS Upgrades -
++ (NSMutableDictionary *)learnedHTTPSHosts
+{
+    //Kept in memory only, so nothing about the pages the user visited outlives the app's process
+    static NSMutableDictionary *learnedHTTPSHosts = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        learnedHTTPSHosts = [NSMutableDictionary dictionary];
+    });
+    
+    return learnedHTTPSHosts;
+}
+
++ (BOOL)hasLearnedHTTPSHost:(NSString *)host
+{
+    NSNumber *learnedTime = [self learnedHTTPSHosts][host];
+    if (learnedTime == nil)
+        return NO;
+    
+    //Sites can stop serving HTTPS, so don't hold onto what we saw forever
+    return ([NSDate timeIntervalSinceReferenceDate] - learnedTime.doubleValue) < HTTPS_UPGRADE_LEARNED_HOST_LIFETIME;
+}
+
++ (void)learnHTTPSHost:(NSString *)host
+{
+    if (host.length == 0)
+        return;
+    
+    NSMutableDictionary *learnedHTTPSHosts = [self learnedHTTPSHosts];
+    learnedHTTPSHosts[host] = @([NSDate timeIntervalSinceReferenceDate]);
+    
+    //Once full, make room by forgetting the hosts that were seen the longest time ago
+    if (learnedHTTPSHosts.count > HTTPS_UPGRADE_LEARNED_HOSTS_MAX_COUNT) {
+        NSArray *hostsByAge = [learnedHTTPSHosts keysSortedByValueUsingSelector:@selector(compare:)];
+        NSRange oldestHosts = NSMakeRange(0, learnedHTTPSHosts.count - HTTPS_UPGRADE_LEARNED_HOSTS_MAX_COUNT);
+        [learnedHTTPSHosts removeObjectsForKeys:[hostsByAge subarrayWithRange:oldestHosts]];
+    }
+}
+
++ (void)resetLearnedHTTPSHosts
+{
+    [[self learnedHTTPSHosts] removeAllObjects];
+}
+
+- (BOOL)URLShouldBeUpgradedToHTTPS:(NSURL *)url
+{
+    //Only plain HTTP on the default port can be upgraded
+    if ([url.scheme caseInsensitiveCompare:@"http"] != NSOrderedSame || url.port != nil)
+        return NO;
+    
+    NSString *host = [url.host lowercaseString];
+    if (host.length == 0)
+        return NO;
+    
+    return [TOWebViewController hasLearnedHTTPSHost:host] || [self hostSet:self.httpsUpgradeHostSet containsHostOfURL:url];
+}
+
+- (void)learnHTTPSRedirectForRequest:(NSURLRequest *)request navigationType:(UIWebViewNavigationType)navigationType
+{
+    //An HTTP page request that is immediately followed by an HTTPS request to the same host, before the
+    //HTTP page finished loading and without the user doing anything, means the site redirected us,
+    //so remember to go straight to HTTPS next time
+    NSURL *url = request.URL;
+    NSString *host = [url.host lowercaseString];
+    
+    if (self.learnsHTTPSRedirects && navigationType == UIWebViewNavigationTypeOther &&
+        [url.scheme caseInsensitiveCompare:@"https"] == NSOrderedSame && url.port == nil &&
+        self.insecurePageRequestHost && [host isEqualToString:self.insecurePageRequestHost])
+    {
+        [TOWebViewController learnHTTPSHost:host];
+    }
+    
+    self.insecurePageRequestHost = nil;
+    if ([url.scheme caseInsensitiveCompare:@"http"] == NSOrderedSame && url.port == nil)
+        self.insecurePageRequestHost = host;
+}
+
+#pragma mark - Web View Pool -
++ (NSMutableArray *)preparedWebViews
+{
+    static NSMutableArray *preparedWebViews = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        preparedWebViews = [NSMutableArray array];
+        
+        //Idle web views are just holding onto memory, so let them go when it's needed elsewhere
+        [[NSNotificationCenter defaultCenter] addObserverForName:UIApplicationDidReceiveMemoryWarningNotification
+                                                          object:nil
+                                                           queue:[NSOperationQueue mainQueue]
+                                                      usingBlock:^(NSNotification *note) {
+                                                          [preparedWebViews removeAllObjects];
+                                                      }];
+    });
+    
+    return preparedWebViews;
+}
+
++ (void)prepareWebViews:(NSUInteger)count
+{
+    NSMutableArray *preparedWebViews = [self preparedWebViews];
+    count = MIN(count, WEB_VIEW_POOL_MAX_COUNT);
+    
+    while (preparedWebViews.count < count) {
+        [preparedWebViews addObject:[[UIWebView alloc] initWithFrame:[UIScreen mainScreen].bounds]];
+    }
+}
+
++ (UIWebView *)dequeuePreparedWebView
+{
+    NSMutableArray *preparedWebViews = [self preparedWebViews];
+    UIWebView *webView = preparedWebViews.lastObject;
+    if (webView) {
+        [preparedWebViews removeLastObject];
+    }
+    
+    return webView;
+}
+
 #pragma mark - Class Cleanup -
 - (void)dealloc
 {
+    [self.webView stopLoading];
     self.webView.delegate = nil;
 }
 
 #pragma mark - Setup -
 - (NSURL *)cleanURL:(NSURL *)url
 {
+    if (url == nil) {
+        return nil;
+    }
+    
     //If no URL scheme was supplied, defer back to HTTP.
     if (url.scheme.length == 0) {
-        url = [NSURL URLWithString:[NSString stringWithFormat:@"http://%@", [url absoluteString]]];
+        url = [NSURL URLWithString:[@"http://" stringByAppendingString:[url absoluteString]]];
+    }
+    
+    //If we know the site will only redirect us to HTTPS, go straight there and save the round trip
+    if ([self URLShouldBeUpgradedToHTTPS:url]) {
+        url = [NSURL URLWithString:[@"https" stringByAppendingString:[url.absoluteString substringFromIndex:4]]] ?: url;
     }
     
     return url;
@@ -195,6 +512,7 @@
     _showPageTitles   = YES;
     _showPageHost   = NO;
     _initialLoad      = YES;
+    _reportsLeaksAfterDismissal = YES;
     
     _progressManager = [[NJKWebViewProgress alloc] init];
     _progressManager.webViewProxyDelegate = self;
@@ -228,16 +546,7 @@
     }
     
     //Create the web view
-    self.webView = [[UIWebView alloc] initWithFrame:self.view.bounds];
-    self.webView.delegate = self.progressManager;
-    self.webView.backgroundColor = [UIColor clearColor];
-    self.webView.autoresizingMask = UIViewAutoresizingFlexibleHeight | UIViewAutoresizingFlexibleWidth;
-    self.webView.scalesPageToFit = YES;
-    self.webView.contentMode = UIViewContentModeRedraw;
-    self.webView.opaque = NO; // Must  be NO to avoid the initial black bars
-    if (@available(iOS 11.0, *)) {
-        self.webView.scrollView.contentInsetAdjustmentBehavior = UIScrollViewContentInsetAdjustmentAutomatic;
-    }
+    self.webView = [self makeWebView];
     [self.view addSubview:self.webView];
 
     CGFloat progressBarHeight = LOADING_BAR_HEIGHT;
@@ -330,11 +639,41 @@
     }
 }
 
+- (UIWebView *)makeWebView
+{
+    //Take a web view that was prepared earlier if there is one
+    UIWebView *webView = [TOWebViewController dequeuePreparedWebView];
+    if (webView) {
+        webView.frame = self.view.bounds;
+    }
+    else {
+        webView = [[UIWebView alloc] initWithFrame:self.view.bounds];
+    }
+    
+    webView.delegate = self.progressManager;
+    webView.backgroundColor = [UIColor clearColor];
+    webView.autoresizingMask = UIViewAutoresizingFlexibleHeight | UIViewAutoresizingFlexibleWidth;
+    webView.scalesPageToFit = YES;
+    webView.contentMode = UIViewContentModeRedraw;
+    webView.opaque = NO; // Must  be NO to avoid the initial black bars
+    if (@available(iOS 11.0, *)) {
+        webView.scrollView.contentInsetAdjustmentBehavior = UIScrollViewContentInsetAdjustmentAutomatic;
+    }
+    
+    return webView;
+}
+
 #pragma mark - View Presentation/Dismissal -
 - (void)viewWillAppear:(BOOL)animated
 {
     [super viewWillAppear:animated];
     
+    //If the web view was released while we were off screen, bring it back (The page reloads once we appear)
+    if (self.webView == nil) {
+        self.webView = [self makeWebView];
+        [self.view insertSubview:self.webView atIndex:0];
+    }
+    
     //Capture the present navigation controller state to restore at the end
     if (self.navigationController && !self.capturedNavigationControllerState) {
         self.hideToolbarOnClose = self.navigationController.toolbarHidden;
@@ -349,7 +688,8 @@
     [self.navigationController.navigationBar addSubview:self.progressView];
     [self.progressView setProgress:0.0f];
     
-    //Layout the buttons
+    //Layout the buttons (The navigation item may have been changed while we were off screen, so always redo it here)
+    self.buttonLayoutKey = nil;
     [UIView performWithoutAnimation:^{
         [self layoutButtonsForCurrentSizeClass];
     }];
@@ -358,6 +698,13 @@
 - (void)viewDidAppear:(BOOL)animated
 {
     [super viewDidAppear:animated];
+    
+    //If the page was preloaded, it's already on its way
+    if (self.initialRequestPreloaded) {
+        self.initialRequestPreloaded = NO;
+        return;
+    }
+    
     //start loading the initial page
     if (self.url && self.webView.request == nil)
     {
@@ -366,6 +713,20 @@
     }
 }
 
+- (void)preload
+{
+    //Make sure the web view has been created
+    [self view];
+    
+    if (self.url == nil || self.webView.request != nil || self.initialRequestPreloaded) {
+        return;
+    }
+    
+    [self.urlRequest setURL:self.url];
+    [self.webView loadRequest:self.urlRequest];
+    self.initialRequestPreloaded = YES;
+}
+
 - (void)viewWillDisappear:(BOOL)animated
 {
     [super viewWillDisappear:animated];
@@ -382,6 +743,39 @@
 {
     [super viewDidDisappear:animated];
     [[UIApplication sharedApplication] setNetworkActivityIndicatorVisible:NO];
+    self.showingNetworkActivityIndicator = NO;
+    
+#ifdef DEBUG
+    //Once we've been popped or dismissed, nothing should be holding onto us for long
+    //(Work out which controller left the hierarchy; either us, or the navigation controller we're in)
+    UIViewController *dismissedController = nil;
+    if (self.navigationController.isBeingDismissed) {
+        dismissedController = self.navigationController;
+    }
+    else if (self.isMovingFromParentViewController || self.isBeingDismissed) {
+        dismissedController = self;
+    }
+    
+    if (self.reportsLeaksAfterDismissal && dismissedController) {
+        __weak typeof(self) weakSelf = self;
+        __weak UIViewController *weakDismissedController = dismissedController;
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(DISMISSED_LEAK_CHECK_DELAY * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+            TOWebViewController *strongSelf = weakSelf;
+            if (strongSelf == nil || strongSelf.reportsLeaksAfterDismissal == NO) {
+                return;
+            }
+            
+            //Skip it if we (or our navigation controller) have since been pushed or presented again
+            UIViewController *controller = weakDismissedController ?: strongSelf;
+            if (controller.parentViewController || controller.presentingViewController || (strongSelf.isViewLoaded && strongSelf.view.window)) {
+                return;
+            }
+            
+            NSLog(@"TOWebViewController: %@ is still alive %.0f seconds after being dismissed, and may have been leaked (Estimated memory: %@ bytes)",
+                  strongSelf, DISMISSED_LEAK_CHECK_DELAY, strongSelf.estimatedMemoryFootprint[TOWebViewMemoryFootprintTotalKey]);
+        });
+    }
+#endif
 }
 
 - (BOOL)shouldAutorotate
@@ -480,9 +874,35 @@
 }
 
 #pragma mark - View Layout/Transitions -
+- (NSArray *)currentButtonLayoutKey
+{
+    //Everything the button layout depends on. While none of these change, the layout won't either.
+    id (^objectOrNull)(id) = ^id(id object) { return object ?: [NSNull null]; };
+    return @[@(self.compactPresentation),
+             @(self.navigationButtonsHidden),
+             @(self.beingPresentedModally),
+             [NSValue valueWithNonretainedObject:self.navigationController], //(Not retained, since it retains us)
+             objectOrNull(self.applicationBarButtonItems),
+             objectOrNull(self.applicationLeftBarButtonItems),
+             objectOrNull(self.backButton),
+             objectOrNull(self.forwardButton),
+             objectOrNull(self.reloadStopButton),
+             objectOrNull(self.actionButton),
+             objectOrNull(self.doneButton)];
+}
+
 - (void)layoutButtonsForCurrentSizeClass
 {
-    [self.navigationController setToolbarHidden:(!self.compactPresentation || self.navigationButtonsHidden) animated:NO];
+    BOOL toolbarHidden = (!self.compactPresentation || self.navigationButtonsHidden);
+    if (self.navigationController.toolbarHidden != toolbarHidden)
+        [self.navigationController setToolbarHidden:toolbarHidden animated:NO];
+    
+    //Resizing in split screen can trigger this many times a second, usually without anything that affects the layout changing
+    NSArray *buttonLayoutKey = [self currentButtonLayoutKey];
+    if ([buttonLayoutKey isEqualToArray:self.buttonLayoutKey])
+        return;
+    
+    self.buttonLayoutKey = buttonLayoutKey;
         
     //Reset the lot
     self.toolbarItems = nil;
@@ -584,11 +1004,11 @@
         
         for (UIBarButtonItem *item in self.applicationBarButtonItems) {
             [rightItems addObject:item];
-            [rightItems addObject:fixedSpace];
+            [rightItems addObject:fixedSpace()];
         }
     }
     else {
-        [leftItems addObject:fixedSpace];
+        [leftItems addObject:fixedSpace()];
         if (self.actionButton)      { [leftItems addObject:self.actionButton];}
         
         if (self.reloadStopButton)  { [rightItems addObject:self.reloadStopButton]; [rightItems addObject:fixedSpace()]; }
@@ -619,6 +1039,173 @@
     }
 }
 
+#pragma mark - Memory Management -
+- (void)didReceiveMemoryWarning
+{
+    [super didReceiveMemoryWarning];
+    
+    //A web view we aren't showing is the single biggest thing we're holding onto, so let it go
+    if (self.unloadsWebViewWhenHidden && [self canUnloadWebView]) {
+        [self unloadWebView];
+    }
+}
+
+- (BOOL)canUnloadWebView
+{
+    if (self.isViewLoaded == NO || self.webView == nil || self.view.window != nil)
+        return NO;
+    
+    //We're only hidden because we're presenting something (eg, the mail composer), and will be straight back
+    if (self.presentedViewController || self.navigationController.presentedViewController)
+        return NO;
+    
+    //Reloading from the URL would resubmit the form as a GET, so the page couldn't be brought back as it was
+    NSString *method = self.webView.request.HTTPMethod;
+    if (method.length && [method caseInsensitiveCompare:@"GET"] != NSOrderedSame)
+        return NO;
+    
+    return YES;
+}
+
+- (void)unloadWebView
+{
+    if (self.webView == nil)
+        return;
+    
+    //Save where we were, the same way state restoration does, so it can be put back when we reappear
+    UIScrollView *scrollView = self.webView.scrollView;
+    NSURL *url = self.webView.request.URL;
+    if (url.absoluteString.length)
+        _url = url;
+    
+    if (self.restoredContentOffset == nil) {
+        self.restoredContentOffset = [NSValue valueWithCGPoint:scrollView.contentOffset];
+        self.restoredZoomScale = scrollView.zoomScale;
+        self.restoredTitle = self.title;
+    }
+    
+    self.readerModeEnabled = NO;
+    [self.webViewRotationSnapshot removeFromSuperview];
+    self.webViewRotationSnapshot = nil;
+    
+    [self.webView stopLoading];
+    self.webView.delegate = nil;
+    [self.webView removeFromSuperview];
+    self.webView = nil;
+    
+    [self.progressManager reset];
+    
+    //Anything preloaded went with the web view, so the page needs to be requested again when we appear
+    self.initialRequestPreloaded = NO;
+}
+
+- (NSDictionary *)estimatedMemoryFootprint
+{
+    //The web view renders at screen resolution, into a backing store at least the size of its visible area
+    CGFloat scale = [UIScreen mainScreen].scale;
+    CGSize webViewSize = self.webView.bounds.size;
+    NSUInteger webViewBytes = (NSUInteger)(webViewSize.width * scale) * (NSUInteger)(webViewSize.height * scale) * 4;
+    
+    NSUInteger snapshotBytes = TOWebViewImageByteCount(self.webViewRotationSnapshot.image);
+    
+    NSUInteger iconBytes = TOWebViewImageByteCount(self.backButton.image) + TOWebViewImageByteCount(self.forwardButton.image) +
+                           TOWebViewImageByteCount(self.reloadIcon) + TOWebViewImageByteCount(self.stopIcon);
+    
+    //Text is stored as UTF-16
+    NSUInteger readerBytes = self.readerTextView.attributedText.length * sizeof(unichar);
+    
+    //The gradient is rendered into a backing store the size of the view
+    NSUInteger gradientBytes = 0;
+    if (self.gradientLayer && self.gradientLayer.hidden == NO) {
+        CGSize gradientSize = self.gradientLayer.bounds.size;
+        gradientBytes = (NSUInteger)(gradientSize.width * scale) * (NSUInteger)(gradientSize.height * scale) * 4;
+    }
+    
+    NSMutableArray *applicationButtons = [NSMutableArray array];
+    if (self.applicationLeftBarButtonItems) { [applicationButtons addObjectsFromArray:self.applicationLeftBarButtonItems]; }
+    if (self.applicationBarButtonItems) { [applicationButtons addObjectsFromArray:self.applicationBarButtonItems]; }
+    
+    NSUInteger applicationButtonBytes = 0;
+    for (UIBarButtonItem *item in applicationButtons) {
+        applicationButtonBytes += TOWebViewImageByteCount(item.image);
+    }
+    
+    return @{TOWebViewMemoryFootprintWebViewKey: @(webViewBytes),
+             TOWebViewMemoryFootprintRotationSnapshotKey: @(snapshotBytes),
+             TOWebViewMemoryFootprintIconsKey: @(iconBytes),
+             TOWebViewMemoryFootprintReaderModeKey: @(readerBytes),
+             TOWebViewMemoryFootprintGradientKey: @(gradientBytes),
+             TOWebViewMemoryFootprintApplicationButtonsKey: @(applicationButtonBytes),
+             TOWebViewMemoryFootprintTotalKey: @(webViewBytes + snapshotBytes + iconBytes + readerBytes + gradientBytes + applicationButtonBytes)};
+}
+
+#pragma mark - State Restoration -
+- (void)encodeRestorableStateWithCoder:(NSCoder *)coder
+{
+    [super encodeRestorableStateWithCoder:coder];
+    
+    //The web view's request can be cleared if the connection dropped, so fall back to our own URL
+    NSURL *url = self.webView.request.URL;
+    if (url.absoluteString.length == 0)
+        url = self.url;
+    
+    if (url == nil)
+        return;
+    
+    UIScrollView *scrollView = self.webView.scrollView;
+    [coder encodeInteger:RESTORATION_STATE_VERSION forKey:RESTORATION_VERSION_KEY];
+    [coder encodeObject:url forKey:RESTORATION_URL_KEY];
+    [coder encodeObject:self.title forKey:RESTORATION_TITLE_KEY];
+    [coder encodeCGPoint:scrollView.contentOffset forKey:RESTORATION_CONTENT_OFFSET_KEY];
+    [coder encodeDouble:scrollView.zoomScale forKey:RESTORATION_ZOOM_SCALE_KEY];
+}
+
+- (void)decodeRestorableStateWithCoder:(NSCoder *)coder
+{
+    [super decodeRestorableStateWithCoder:coder];
+    
+    //Ignore state saved in a format we don't know about
+    if ([coder decodeIntegerForKey:RESTORATION_VERSION_KEY] != RESTORATION_STATE_VERSION)
+        return;
+    
+    NSURL *url = [coder decodeObjectForKey:RESTORATION_URL_KEY];
+    if ([url isKindOfClass:[NSURL class]] == NO)
+        return;
+    
+    //Show the old title straight away, while the page itself reloads
+    NSString *title = [coder decodeObjectForKey:RESTORATION_TITLE_KEY];
+    if ([title isKindOfClass:[NSString class]] && title.length)
+        self.restoredTitle = title;
+    
+    self.restoredContentOffset = [NSValue valueWithCGPoint:[coder decodeCGPointForKey:RESTORATION_CONTENT_OFFSET_KEY]];
+    self.restoredZoomScale = [coder decodeDoubleForKey:RESTORATION_ZOOM_SCALE_KEY];
+    
+    self.url = url;
+}
+
+- (void)applyRestoredScrollPosition
+{
+    if (self.restoredContentOffset == nil)
+        return;
+    
+    UIScrollView *scrollView = self.webView.scrollView;
+    if (self.restoredZoomScale > FLT_EPSILON)
+        [scrollView setZoomScale:self.restoredZoomScale animated:NO];
+    
+    //The page may have changed size since it was saved, so keep the offset inside its bounds
+    UIEdgeInsets insets = self.scrollViewContentInsets;
+    CGPoint contentOffset = self.restoredContentOffset.CGPointValue;
+    CGFloat maxOffsetX = MAX(-insets.left, scrollView.contentSize.width + insets.right - CGRectGetWidth(scrollView.bounds));
+    CGFloat maxOffsetY = MAX(-insets.top, scrollView.contentSize.height + insets.bottom - CGRectGetHeight(scrollView.bounds));
+    contentOffset.x = MAX(-insets.left, MIN(contentOffset.x, maxOffsetX));
+    contentOffset.y = MAX(-insets.top, MIN(contentOffset.y, maxOffsetY));
+    [scrollView setContentOffset:contentOffset animated:NO];
+    
+    self.restoredContentOffset = nil;
+    self.restoredZoomScale = 0.0f;
+    self.restoredTitle = nil;
+}
+
 #pragma mark -
 #pragma mark Manual Property Accessors
 - (void)setUrl:(NSURL *)url
@@ -764,6 +1351,85 @@
     [self refreshButtonsState];
 }
 
+- (void)setBlockedRequestHosts:(NSArray *)blockedRequestHosts
+{
+    if (blockedRequestHosts == _blockedRequestHosts)
+        return;
+    
+    _blockedRequestHosts = [blockedRequestHosts copy];
+    
+    if (_blockedRequestHosts.count == 0) {
+        self.blockedRequestHostSet = nil;
+        return;
+    }
+    
+    self.blockedRequestHostSet = [self hostSetFromHosts:_blockedRequestHosts];
+}
+
+- (BOOL)requestHostIsBlocked:(NSURL *)url
+{
+    return [self hostSet:self.blockedRequestHostSet containsHostOfURL:url];
+}
+
+- (void)setHttpsUpgradeHosts:(NSArray *)httpsUpgradeHosts
+{
+    if (httpsUpgradeHosts == _httpsUpgradeHosts)
+        return;
+    
+    _httpsUpgradeHosts = [httpsUpgradeHosts copy];
+    self.httpsUpgradeHostSet = (_httpsUpgradeHosts.count ? [self hostSetFromHosts:_httpsUpgradeHosts] : nil);
+    
+    //If the initial page hasn't been requested yet, it can still be upgraded
+    if (_url && self.webView.request == nil && self.initialRequestPreloaded == NO)
+        _url = [self cleanURL:_url];
+}
+
+- (NSSet *)hostSetFromHosts:(NSArray *)hosts
+{
+    //Normalize the hosts once now, so each request only needs a set lookup per domain level
+    NSMutableSet *hostSet = [NSMutableSet setWithCapacity:hosts.count];
+    for (NSString *host in hosts) {
+        NSString *normalizedHost = [host lowercaseString];
+        if ([normalizedHost hasPrefix:@"*."])
+            normalizedHost = [normalizedHost substringFromIndex:2];
+        else if ([normalizedHost hasPrefix:@"."])
+            normalizedHost = [normalizedHost substringFromIndex:1];
+        
+        //A trailing dot marks a fully qualified name, but it's still the same host
+        if ([normalizedHost hasSuffix:@"."])
+            normalizedHost = [normalizedHost substringToIndex:normalizedHost.length - 1];
+        
+        if (normalizedHost.length)
+            [hostSet addObject:normalizedHost];
+    }
+    
+    return hostSet;
+}
+
+- (BOOL)hostSet:(NSSet *)hostSet containsHostOfURL:(NSURL *)url
+{
+    NSString *host = [url.host lowercaseString];
+    if ([host hasSuffix:@"."])
+        host = [host substringToIndex:host.length - 1];
+    
+    if (hostSet == nil || host.length == 0)
+        return NO;
+    
+    //Check the host itself, and then each parent domain of it
+    while (host.length) {
+        if ([hostSet containsObject:host])
+            return YES;
+        
+        NSRange range = [host rangeOfString:@"."];
+        if (range.location == NSNotFound)
+            break;
+        
+        host = [host substringFromIndex:range.location + 1];
+    }
+    
+    return NO;
+}
+
 - (void)setShowPageHost:(BOOL)showPageHost
 {
     _showPageHost = showPageHost;
@@ -794,16 +1460,56 @@
 {
     BOOL shouldStart = YES;
     
+    //Block any requests to hosts in the blocked list
+    if ([self requestHostIsBlocked:request.URL]) {
+        return NO;
+    }
+    
     //If a request handler has been set, check to see if we should go ahead
     if (self.shouldStartLoadRequestHandler) {
         shouldStart = self.shouldStartLoadRequestHandler(request, navigationType);
     }
+    
+    //Note when a new page was requested, so its load can be timed once the progress resets
+    if (shouldStart && [request.URL isEqual:request.mainDocumentURL]) {
+        _loadMetrics.pendingRequestTime = CACurrentMediaTime();
+        
+        [self learnHTTPSRedirectForRequest:request navigationType:navigationType];
+        
+        //Any page request other than our own retry from the cache is a fresh start
+        self.pageRequestURL = request.URL;
+        if (self.loadingFromOfflineCache) {
+            self.loadingFromOfflineCache = NO;
+        }
+        else {
+            self.offlineCacheFallbackError = nil;
+        }
+    }
         
     return shouldStart;
 }
 
 - (void)webView:(UIWebView *)webView didFailLoadWithError:(NSError *)error
 {
+    //If we're offline, see if the page can be shown from the cache instead
+    if ([self loadPageFromCacheAfterError:error]) {
+        return;
+    }
+    
+    //If the cached copy couldn't be loaded either, report why we went looking for it
+    //(Failures of the page's frames or resources are reported as they are)
+    NSURL *failingURL = error.userInfo[NSURLErrorFailingURLErrorKey];
+    if (self.offlineCacheFallbackError && failingURL && [failingURL isEqual:self.pageRequestURL]) {
+        error = self.offlineCacheFallbackError;
+        self.offlineCacheFallbackError = nil;
+    }
+    
+    //Note when the page itself failed, so its metrics aren't reported as a completed load
+    //(Cancellations are skipped, as they're caused by the next navigation replacing this one)
+    if (failingURL && [failingURL isEqual:self.pageRequestURL] && error.code != NSURLErrorCancelled) {
+        self.loadMetricsError = error;
+    }
+    
     //If a request handler has been set, check to see if we should go ahead
     if (self.didFailLoadWithErrorRequestHandler) {
         return self.didFailLoadWithErrorRequestHandler(error);
@@ -812,21 +1518,71 @@
 
 - (void)webViewDidStartLoad:(UIWebView *)webView
 {
-    //show that loading started in the status bar
-    [[UIApplication sharedApplication] setNetworkActivityIndicatorVisible:YES];
+    if (_loadMetrics.startLoadTime == 0) {
+        _loadMetrics.startLoadTime = CACurrentMediaTime();
+    }
     
-    //update the navigation bar buttons
+    //update the navigation bar buttons (This also shows that loading started in the status bar)
     [self refreshButtonsState];
 }
 
 -(void)webViewDidFinishLoad:(UIWebView *)webView
 {
+    //Once the HTTP page has loaded, it wasn't redirected, so anything after it doesn't count as a redirect
+    self.insecurePageRequestHost = nil;
+    
     if (self.didFinishLoadHandler) {
         self.didFinishLoadHandler(webView);
     }
 }
 
+- (BOOL)loadPageFromCacheAfterError:(NSError *)error
+{
+    if (self.loadsFromCacheWhenOffline == NO || self.offlineCacheFallbackError) {
+        return NO;
+    }
+    
+    if ([error.domain isEqualToString:NSURLErrorDomain] == NO) {
+        return NO;
+    }
+    
+    switch (error.code) {
+        case NSURLErrorNotConnectedToInternet:
+        case NSURLErrorNetworkConnectionLost:
+        case NSURLErrorCannotFindHost:
+        case NSURLErrorCannotConnectToHost:
+        case NSURLErrorTimedOut:
+        case NSURLErrorDataNotAllowed:
+        case NSURLErrorInternationalRoamingOff:
+            break;
+        default:
+            return NO;
+    }
+    
+    //Only fall back for the page itself, not any of its frames or resources
+    NSURL *failingURL = error.userInfo[NSURLErrorFailingURLErrorKey];
+    if (failingURL == nil || self.pageRequestURL == nil || [failingURL isEqual:self.pageRequestURL] == NO) {
+        return NO;
+    }
+    
+    self.offlineCacheFallbackError = error;
+    self.loadingFromOfflineCache = YES;
+    
+    NSMutableURLRequest *request = [self.urlRequest mutableCopy];
+    request.URL = failingURL;
+    request.cachePolicy = NSURLRequestReturnCacheDataDontLoad;
+    [self.webView loadRequest:request];
+    
+    return YES;
+}
+
 #pragma mark - Progress Delegate -
+- (BOOL)webViewProgress:(NJKWebViewProgress *)webViewProgress shouldCompleteProgressForError:(NSError *)error
+{
+    //The page is being retried from the cache, so it hasn't finished yet
+    return (self.loadingFromOfflineCache == NO && error != self.offlineCacheFallbackError);
+}
+
 -(void)webViewProgress:(NJKWebViewProgress *)webViewProgress updateProgress:(float)progress
 {
     [self.progressView setProgress:progress animated:YES];
@@ -837,76 +1593,452 @@
         self.webView.opaque = YES;
     }
     
-    //Query the webview to see what load state JavaScript perceives it at
-    NSString *readyState = [self.webView stringByEvaluatingJavaScriptFromString:@"document.readyState"];
+    //A progress reset means a new page is on its way, so anything we captured is now stale
+    if (progress < FLT_EPSILON) {
+        self.injectedUserScriptTimes = 0;
+        self.readerModeEnabled = NO;
+        [self resetPageState];
+        [self resetLoadMetrics];
+        [self refreshButtonsState];
+        return;
+    }
+    
+    //Query the webview for its load state, title, host and background colour all at once
+    [self updatePageStateForProgress:progress];
+    
+    //Run any user scripts for the stage the document has now reached
+    //(This also disables the ability to tap and hold on links, if the app desires it)
+    [self injectUserScriptsForReadyState:self.pageReadyState];
     
     //interactive means the page has loaded sufficiently to allow user interaction now
-    BOOL interactive = [readyState isEqualToString:@"interactive"];
-    BOOL complete = [readyState isEqualToString:@"complete"];
+    BOOL interactive = [self.pageReadyState isEqualToString:@"interactive"];
+    BOOL complete = [self.pageReadyState isEqualToString:@"complete"];
+    if ((interactive || complete) && _loadMetrics.interactiveTime == 0) {
+        _loadMetrics.interactiveTime = CACurrentMediaTime();
+    }
+    
     if (interactive || complete)
     {
         //see if we can set the proper page title yet
+        NSString *title = nil;
         if (self.showPageTitles) {
-            NSString *title = [self.webView stringByEvaluatingJavaScriptFromString:@"document.title"];
-            
-            if (title.length)
-                self.title = title;
+            if (self.pageTitle.length)
+                title = self.pageTitle;
         } else if (self.showPageHost) {
-            NSString *host = [self.webView stringByEvaluatingJavaScriptFromString:@"window.location.hostname"];
-            if (host.length) {
-                self.title = [self shortenHostname:host];
+            if (self.pageHost.length) {
+                title = [self shortenHostname:self.pageHost];
             }
         }
         
+        //(Setting the title relayouts the navigation bar, so only do it when it actually changes)
+        if (title && [title isEqualToString:self.title] == NO)
+            self.title = title;
+        
         //if we're matching the view BG to the web view, update the background colour now
         if (self.hideWebViewBoundaries)
-            self.view.backgroundColor = [self webViewPageBackgroundColor];
+            [self updateBackgroundColorFromPage];
+    }
+    
+    if (progress >= 1.0f - FLT_EPSILON) {
+        //If this was the page being shown from the cache, it made it, so there's no earlier failure to report any more
+        self.offlineCacheFallbackError = nil;
         
-        //finally, if the app desires it, disable the ability to tap and hold on links
-        if (self.disableContextualPopupMenu)
-            [self.webView stringByEvaluatingJavaScriptFromString:@"document.body.style.webkitTouchCallout='none';"];
+        [self applyRestoredScrollPosition];
+        [self reportLoadMetrics];
     }
     
     [self refreshButtonsState];
 }
 
-- (NSString *)shortenHostname:(NSString *)hostname {
-    if (hostname && hostname.length) {
-        if ([hostname hasPrefix:@"www"]) {
-            return [hostname substringFromIndex:4];
+- (void)updateBackgroundColorFromPage
+{
+    //The page state captures the colour as soon as the page has a body. Until then, there's nothing
+    //to match yet, and the next progress update will try again.
+    if (self.pageBackgroundColorString)
+        [self setViewBackgroundColorFromCSSColorString:self.pageBackgroundColorString];
+}
+
+- (void)setViewBackgroundColorFromCSSColorString:(NSString *)colorString
+{
+    UIColor *backgroundColor = [self colorFromCSSColorString:colorString];
+    if ([backgroundColor isEqual:self.view.backgroundColor] == NO)
+        self.view.backgroundColor = backgroundColor;
+}
+
+#pragma mark - User Scripts -
+- (void)addUserScript:(NSString *)source injectionTime:(TOWebViewUserScriptInjectionTime)injectionTime
+{
+    if (source.length == 0)
+        return;
+    
+    if (self.userScripts == nil)
+        self.userScripts = [NSMutableArray array];
+    
+    [self.userScripts addObject:@{@"source": [source copy], @"injectionTime": @(injectionTime)}];
+    self.userScriptPayloads = nil;
+}
+
+- (void)removeAllUserScripts
+{
+    [self.userScripts removeAllObjects];
+    self.userScriptPayloads = nil;
+}
+
+- (void)setDisableContextualPopupMenu:(BOOL)disableContextualPopupMenu
+{
+    if (disableContextualPopupMenu == _disableContextualPopupMenu)
+        return;
+    
+    _disableContextualPopupMenu = disableContextualPopupMenu;
+    self.userScriptPayloads = nil;
+}
+
+- (NSString *)userScriptPayloadForInjectionTime:(TOWebViewUserScriptInjectionTime)injectionTime
+{
+    //Build every script for each injection time into a single payload, so each one only needs one call into the page
+    if (self.userScriptPayloads == nil) {
+        NSMutableString *interactivePayload = [NSMutableString string];
+        NSMutableString *completePayload = [NSMutableString string];
+        
+        //(Guarded, since a frameset or a very early document has no body, and throwing here would skip every script after it)
+        if (self.disableContextualPopupMenu)
+            [interactivePayload appendString:DISABLE_CONTEXTUAL_POPUP_SCRIPT];
+        
+        //Each script is wrapped in its own function and try block, so one failing can't stop the others
+        for (NSDictionary *userScript in self.userScripts) {
+            BOOL complete = ([userScript[@"injectionTime"] integerValue] == TOWebViewUserScriptInjectionTimeComplete);
+            NSMutableString *payload = complete ? completePayload : interactivePayload;
+            [payload appendFormat:@"try{(function(){%@\n})();}catch(e){}", userScript[@"source"]];
         }
+        
+        self.userScriptPayloads = @[[interactivePayload copy], [completePayload copy]];
     }
-    return hostname;
+    
+    NSUInteger index = (injectionTime == TOWebViewUserScriptInjectionTimeComplete) ? 1 : 0;
+    return self.userScriptPayloads[index];
+}
+
+- (void)injectUserScriptsForReadyState:(NSString *)readyState
+{
+    BOOL complete = [readyState isEqualToString:@"complete"];
+    BOOL interactive = complete || [readyState isEqualToString:@"interactive"];
+    
+    //Scripts are injected in order, once per document
+    if (interactive)
+        [self injectUserScriptsForInjectionTime:TOWebViewUserScriptInjectionTimeInteractive];
+    
+    if (complete)
+        [self injectUserScriptsForInjectionTime:TOWebViewUserScriptInjectionTimeComplete];
+}
+
+- (void)injectUserScriptsForInjectionTime:(TOWebViewUserScriptInjectionTime)injectionTime
+{
+    NSUInteger flag = (1 << injectionTime);
+    if (self.injectedUserScriptTimes & flag)
+        return;
+    
+    self.injectedUserScriptTimes |= flag;
+    
+    NSString *payload = [self userScriptPayloadForInjectionTime:injectionTime];
+    if (payload.length == 0)
+        return;
+    
+    //The document keeps its own record too, in case our progress is reset without a new document being loaded
+    NSString *script = [NSString stringWithFormat:@"(function(w){if(w.__toUserScripts%ld){return;}w.__toUserScripts%ld=1;%@})(window);",
+                                                    (long)injectionTime, (long)injectionTime, payload];
+    [self evaluateJavaScript:script];
+}
+
+#pragma mark - Page Load Metrics -
+- (void)resetLoadMetrics
+{
+    //Time the new page from when it was requested, or from now if it was loaded some other way
+    CFTimeInterval requestTime = _loadMetrics.pendingRequestTime;
+    if (requestTime == 0) {
+        requestTime = CACurrentMediaTime();
+    }
+    
+    memset(&_loadMetrics, 0, sizeof(_loadMetrics));
+    _loadMetrics.requestTime = requestTime;
+    self.loadMetricsError = nil;
+}
+
+- (void)reportLoadMetrics
+{
+    if (_loadMetrics.reported || _loadMetrics.requestTime == 0) {
+        return;
+    }
+    _loadMetrics.reported = YES;
+    
+    if (self.pageLoadMetricsHandler == nil) {
+        return;
+    }
+    
+    CFTimeInterval requestTime = _loadMetrics.requestTime;
+    NSMutableDictionary *metrics = [NSMutableDictionary dictionary];
+    if (self.webView.request.URL) {
+        metrics[TOWebViewPageLoadMetricsURLKey] = self.webView.request.URL;
+    }
+    if (_loadMetrics.startLoadTime > 0) {
+        metrics[TOWebViewPageLoadMetricsStartLoadIntervalKey] = @(MAX(0.0, _loadMetrics.startLoadTime - requestTime));
+    }
+    if (_loadMetrics.interactiveTime > 0) {
+        metrics[TOWebViewPageLoadMetricsInteractiveIntervalKey] = @(MAX(0.0, _loadMetrics.interactiveTime - requestTime));
+    }
+    if (self.loadMetricsError) {
+        metrics[TOWebViewPageLoadMetricsErrorKey] = self.loadMetricsError;
+    }
+    else {
+        metrics[TOWebViewPageLoadMetricsCompleteIntervalKey] = @(MAX(0.0, CACurrentMediaTime() - requestTime));
+    }
+    metrics[TOWebViewPageLoadMetricsScriptCallCountKey] = @(_loadMetrics.scriptCallCount);
+    metrics[TOWebViewPageLoadMetricsScriptDurationKey] = @(_loadMetrics.scriptDuration);
+    
+    self.pageLoadMetricsHandler(metrics);
+}
+
+- (NSString *)evaluateJavaScript:(NSString *)script
+{
+    //Calls into the page block the main thread until they return, so keep track of how much they cost
+    CFTimeInterval startTime = CACurrentMediaTime();
+    NSString *result = [self.webView stringByEvaluatingJavaScriptFromString:script];
+    
+    _loadMetrics.scriptCallCount++;
+    _loadMetrics.scriptDuration += CACurrentMediaTime() - startTime;
+    
+    return result;
+}
+
+#pragma mark - Page State -
+- (void)updatePageStateForProgress:(float)progress
+{
+    //Once the page has completely loaded, nothing we capture will change until the next navigation
+    if (self.pageStateComplete) {
+        return;
+    }
+    
+    NSString *snapshot = [self evaluateJavaScript:PAGE_STATE_SCRIPT];
+    [self setPageStateFromSnapshot:snapshot];
+    
+    self.pageStateComplete = (progress >= 1.0f - FLT_EPSILON && [self.pageReadyState isEqualToString:@"complete"]);
+}
+
+- (void)setPageStateFromSnapshot:(NSString *)snapshot
+{
+    NSArray *components = [snapshot componentsSeparatedByString:PAGE_STATE_SEPARATOR];
+    
+    //If the format isn't one we recognise, treat the page state as unknown
+    if (components.count < 6 || [components[0] isEqualToString:PAGE_STATE_VERSION] == NO) {
+        [self resetPageState];
+        return;
+    }
+    
+    self.pageReadyState = components[1];
+    self.pageTitle      = components[2];
+    self.pageHost       = components[3];
+    
+    //The background colour and viewport are only captured once the page body is available
+    NSString *backgroundColorString = components[4];
+    self.pageBackgroundColorString = backgroundColorString.length ? backgroundColorString : nil;
+    
+    NSString *viewportContent = nil;
+    if ([self.pageReadyState isEqualToString:@"interactive"] || [self.pageReadyState isEqualToString:@"complete"]) {
+        viewportContent = components[5];
+    }
+    
+    if (viewportContent != self.pageViewportContent && [viewportContent isEqualToString:self.pageViewportContent] == NO) {
+        self.pageViewportContent = viewportContent;
+        self.pageViewportParsed = NO;
+    }
+}
+
+- (void)resetPageState
+{
+    self.pageReadyState = nil;
+    self.pageTitle = nil;
+    self.pageHost = nil;
+    self.pageBackgroundColorString = nil;
+    self.pageViewportContent = nil;
+    self.pageViewportParsed = NO;
+    self.pageStateComplete = NO;
+}
+
+- (NSString *)shortenHostname:(NSString *)hostname
+{
+    if (hostname.length == 0)
+        return hostname;
+    
+    //The title is refreshed on every progress update, so reuse the last result while the host stays the same
+    if ([hostname isEqualToString:self.shortenedHostnameSource])
+        return self.shortenedHostname;
+    
+    NSString *shortenedHostname = TOWebViewRegistrableDomainForHost(hostname);
+    self.shortenedHostnameSource = hostname;
+    self.shortenedHostname = shortenedHostname;
+    
+    return shortenedHostname;
+}
+
+#pragma mark - Reader Mode -
+- (void)setReaderModeEnabled:(BOOL)readerModeEnabled
+{
+    if (readerModeEnabled == _readerModeEnabled)
+        return;
+    
+    if (readerModeEnabled == NO) {
+        _readerModeEnabled = NO;
+        [self.readerTextView removeFromSuperview];
+        self.readerTextView = nil;
+        self.webView.hidden = NO;
+        return;
+    }
+    
+    NSAttributedString *readerText = [self readerTextForCurrentPage];
+    if (readerText.length == 0)
+        return;
+    
+    _readerModeEnabled = YES;
+    
+    UITextView *textView = [[UITextView alloc] initWithFrame:self.webView.frame];
+    textView.autoresizingMask = UIViewAutoresizingFlexibleHeight | UIViewAutoresizingFlexibleWidth;
+    textView.backgroundColor = [UIColor whiteColor];
+    textView.editable = NO;
+    if (MINIMAL_UI)
+        textView.textContainerInset = UIEdgeInsetsMake(20.0f, 15.0f, 20.0f, 15.0f);
+    textView.contentInset = self.scrollViewContentInsets;
+    textView.scrollIndicatorInsets = self.scrollViewContentInsets;
+    textView.attributedText = readerText;
+    [self.view insertSubview:textView aboveSubview:self.webView];
+    self.readerTextView = textView;
+    
+    //There's no need for the web view to keep drawing underneath
+    self.webView.hidden = YES;
+}
+
+- (NSAttributedString *)readerTextForCurrentPage
+{
+    NSString *json = [self evaluateJavaScript:READER_CONTENT_SCRIPT];
+    NSData *data = [json dataUsingEncoding:NSUTF8StringEncoding];
+    if (data.length == 0)
+        return nil;
+    
+    NSDictionary *content = [NSJSONSerialization JSONObjectWithData:data options:kNilOptions error:nil];
+    if ([content isKindOfClass:[NSDictionary class]] == NO)
+        return nil;
+    
+    NSArray *blocks = content[@"blocks"];
+    if ([blocks isKindOfClass:[NSArray class]] == NO || blocks.count == 0)
+        return nil;
+    
+    NSMutableParagraphStyle *paragraphStyle = [[NSMutableParagraphStyle alloc] init];
+    paragraphStyle.paragraphSpacing = 12.0f;
+    paragraphStyle.lineSpacing = 3.0f;
+    
+    NSDictionary *bodyAttributes = @{NSFontAttributeName: [UIFont systemFontOfSize:17.0f],
+                                     NSParagraphStyleAttributeName: paragraphStyle};
+    NSDictionary *headingAttributes = @{NSFontAttributeName: [UIFont boldSystemFontOfSize:20.0f],
+                                        NSParagraphStyleAttributeName: paragraphStyle};
+    NSDictionary *titleAttributes = @{NSFontAttributeName: [UIFont boldSystemFontOfSize:26.0f],
+                                      NSParagraphStyleAttributeName: paragraphStyle};
+    
+    NSMutableAttributedString *readerText = [[NSMutableAttributedString alloc] init];
+    
+    NSString *title = content[@"title"];
+    if ([title isKindOfClass:[NSString class]] && title.length) {
+        [readerText appendAttributedString:[[NSAttributedString alloc] initWithString:[title stringByAppendingString:@"\n"] attributes:titleAttributes]];
+    }
+    
+    for (NSArray *block in blocks) {
+        if ([block isKindOfClass:[NSArray class]] == NO || block.count < 2)
+            continue;
+        
+        NSString *tagName = block[0];
+        NSString *text = block[1];
+        if ([tagName isKindOfClass:[NSString class]] == NO || [text isKindOfClass:[NSString class]] == NO)
+            continue;
+        
+        //Headings are bold, list items are bulleted, and everything else is a plain paragraph
+        NSDictionary *attributes = bodyAttributes;
+        if ([tagName hasPrefix:@"h"]) {
+            attributes = headingAttributes;
+        }
+        else if ([tagName isEqualToString:@"li"]) {
+            text = [@"\u2022 " stringByAppendingString:text];
+        }
+        
+        [readerText appendAttributedString:[[NSAttributedString alloc] initWithString:[text stringByAppendingString:@"\n"] attributes:attributes]];
+    }
+    
+    return readerText;
+}
+
+#pragma mark - Find in Page -
+- (NSUInteger)highlightOccurrencesOfString:(NSString *)string
+{
+    //Pass the query in as a JSON array, so it's properly escaped for JavaScript
+    NSData *argumentData = [NSJSONSerialization dataWithJSONObject:@[string ?: @""] options:0 error:nil];
+    NSString *argument = [[NSString alloc] initWithData:argumentData encoding:NSUTF8StringEncoding];
+    if (argument == nil)
+        return 0;
+    
+    //(JSON allows these two separators inside strings, but JavaScript string literals don't)
+    argument = [argument stringByReplacingOccurrencesOfString:@"\u2028" withString:@"\\u2028"];
+    argument = [argument stringByReplacingOccurrencesOfString:@"\u2029" withString:@"\\u2029"];
+    
+    NSString *script = [NSString stringWithFormat:@"(%@)(%@[0])", FIND_IN_PAGE_SCRIPT, argument];
+    return (NSUInteger)MAX(0, [[self evaluateJavaScript:script] integerValue]);
+}
+
+- (void)removeHighlights
+{
+    [self highlightOccurrencesOfString:@""];
 }
 
 #pragma mark -
 #pragma mark UI State Handling
 - (void)refreshButtonsState
 {
+    //Loading a single page can trigger dozens of delegate and progress events in a row,
+    //so gather them up and update the buttons once they've all been handled
+    if (self.buttonsStateRefreshPending)
+        return;
+    
+    self.buttonsStateRefreshPending = YES;
+    
+    __weak typeof(self) weakSelf = self;
+    dispatch_async(dispatch_get_main_queue(), ^{
+        weakSelf.buttonsStateRefreshPending = NO;
+        [weakSelf updateButtonsState];
+    });
+}
+
+- (void)updateButtonsState
+{
+    //Only touch the properties whose values have actually changed, since each one can trigger a relayout
+    
     //update the state for the back button
-    if (self.webView.canGoBack)
-        [self.backButton setEnabled:YES];
-    else
-        [self.backButton setEnabled:NO];
+    BOOL canGoBack = self.webView.canGoBack;
+    if (self.backButton.enabled != canGoBack)
+        [self.backButton setEnabled:canGoBack];
     
     //Forward button
-    if (self.webView.canGoForward)
-        [self.forwardButton setEnabled:YES];
-    else
-        [self.forwardButton setEnabled:NO];
+    BOOL canGoForward = self.webView.canGoForward;
+    if (self.forwardButton.enabled != canGoForward)
+        [self.forwardButton setEnabled:canGoForward];
     
     BOOL loaded = (self.progressManager.progress >= 1.0f - FLT_EPSILON);
     
-    //Stop/Reload Button
-    if (!loaded) {
-        [[UIApplication sharedApplication] setNetworkActivityIndicatorVisible:YES];
-        self.reloadStopButton.image = self.stopIcon;
-    }
-    else {
-        [[UIApplication sharedApplication] setNetworkActivityIndicatorVisible:NO];
-        self.reloadStopButton.image = self.reloadIcon;
+    //Network activity indicator
+    if (self.showingNetworkActivityIndicator != !loaded) {
+        self.showingNetworkActivityIndicator = !loaded;
+        [[UIApplication sharedApplication] setNetworkActivityIndicatorVisible:!loaded];
     }
     
+    //Stop/Reload Button
+    UIImage *reloadStopIcon = loaded ? self.reloadIcon : self.stopIcon;
+    if (self.reloadStopButton.image != reloadStopIcon)
+        self.reloadStopButton.image = reloadStopIcon;
+    
     //Any potential user-specified buttons
     if (self.loadCompletedApplicationBarButtonItems) {
         BOOL enabled = NO;
@@ -915,15 +2047,20 @@
         }
         
         for (UIBarButtonItem *item in self.loadCompletedApplicationBarButtonItems) {
-            item.enabled = enabled;
+            if (item.enabled != enabled)
+                item.enabled = enabled;
         }
     }
 }
 
 - (void)showPlaceholderTitle
 {
+    //if we're restoring a page, show the title it had last time
+    if (self.restoredTitle) {
+        self.title = self.restoredTitle;
+    }
     //set the title to the URL until we load the page properly
-    if (self.url && (self.showPageTitles || self.showPageHost) && self.showUrlWhileLoading) {
+    else if (self.url && (self.showPageTitles || self.showPageHost) && self.showUrlWhileLoading) {
         self.title = [self shortenHostname:_url.host];
     }
     else if (self.showPageTitles) {
@@ -1226,86 +2363,67 @@
 
 - (BOOL)webViewPageWidthIsDynamic
 {
-    //A bit of a crazy JavaScript that scans the HTML for a <meta name="viewport"> tag and retrieves its contents
-    NSString *metaDataQuery =   @"(function() {"
-                                @"var metaTags = document.getElementsByTagName('meta');"
-                                @"for (i=0; i<metaTags.length; i++) {"
-                                @"if (metaTags[i].name=='viewport') {"
-                                @"return metaTags[i].getAttribute('content');"
-                                @"}"
-                                @"}"
-                                @"})()";
-    
-    NSString *pageViewPortContent = [self.webView stringByEvaluatingJavaScriptFromString:metaDataQuery];
-    if ([pageViewPortContent length] == 0) {
-        return NO;
+    //Once the current page's viewport has been parsed, rotations don't need to query the web view again
+    if (self.pageViewportParsed) {
+        return self.pageWidthIsDynamic;
     }
     
-    //remove all white space and make sure it's all lower case
-    pageViewPortContent = [[pageViewPortContent stringByReplacingOccurrencesOfString:@" " withString:@""] lowercaseString];
-    
-    //check if the max page zoom is locked at 1
-    if ([pageViewPortContent rangeOfString:@"maximum-scale=1"].location != NSNotFound) {
-        return YES;
+    //Use the viewport content captured with the page state if we have it, otherwise pull it from the web view
+    NS_VALID_UNTIL_END_OF_SCOPE NSString *pageViewPortContent = self.pageViewportContent;
+    BOOL cacheable = (pageViewPortContent != nil);
+    if (pageViewPortContent == nil) {
+        NSString *metaDataQuery = @"(function(){var m=document.querySelector('meta[name=viewport]');return m?m.getAttribute('content'):'';})()";
+        pageViewPortContent = [self evaluateJavaScript:metaDataQuery];
     }
     
-    //check if zooming is intentionally disabled
-    if ([pageViewPortContent rangeOfString:@"user-scalable=no"].location != NSNotFound) {
-        return YES;
+    //Viewport content is almost always short enough to copy onto the stack, but fall back to
+    //the string's own UTF-8 buffer for anything longer, rather than giving up on it
+    BOOL pageWidthIsDynamic = NO;
+    char viewportBuffer[1024];
+    const char *viewportString = NULL;
+    if ([pageViewPortContent length] > 0) {
+        if ([pageViewPortContent getCString:viewportBuffer maxLength:sizeof(viewportBuffer) encoding:NSUTF8StringEncoding])
+            viewportString = viewportBuffer;
+        else
+            viewportString = [pageViewPortContent UTF8String];
     }
     
-    //check if width is set to align to the width of the device
-    if ([pageViewPortContent rangeOfString:@"width=device-width"].location != NSNotFound) {
-        return YES;
+    if (viewportString) {
+        TOWebViewViewport viewport;
+        TOWebViewParseViewport(viewportString, &viewport);
+        pageWidthIsDynamic = TOWebViewViewportIsDynamic(&viewport);
     }
     
-    //check if initial scale is being forced (Apple seem to blanket apply this in Safari)
-    if ([pageViewPortContent rangeOfString:@"initial-scale=1"].location != NSNotFound) {
-        return YES;
+    if (cacheable) {
+        self.pageWidthIsDynamic = pageWidthIsDynamic;
+        self.pageViewportParsed = YES;
     }
     
-    return NO;
+    return pageWidthIsDynamic;
 }
 
 - (UIColor *)webViewPageBackgroundColor
 {
-    //Pull the current background colour from the web view
-    NSString *rgbString = [self.webView stringByEvaluatingJavaScriptFromString:@"window.getComputedStyle(document.body,null).getPropertyValue('background-color');"];
+    //Use the colour captured with the page state if we have it, otherwise pull it from the web view
+    NSString *rgbString = self.pageBackgroundColorString;
+    if (rgbString == nil)
+        rgbString = [self evaluateJavaScript:PAGE_BACKGROUND_COLOR_SCRIPT];
     
-    //if it wasn't found, or if it isn't a proper rgb value, just return white as the default
-    if ([rgbString length] == 0 || [rgbString rangeOfString:@"rgb"].location == NSNotFound)
+    return [self colorFromCSSColorString:rgbString];
+}
+
+- (UIColor *)colorFromCSSColorString:(NSString *)rgbString
+{
+    //if it wasn't found, or if it isn't a colour we can parse, just return white as the default
+    UIColor *color = TOWebViewColorFromCSSString(rgbString);
+    if (color == nil)
         return [UIColor whiteColor];
     
-    //Assuming now the input is either 'rgb(255, 0, 0)' or 'rgba(255, 0, 0, 255)'
-    
-    //remove the 'rgba' componenet
-    rgbString = [rgbString stringByReplacingOccurrencesOfString:@"rgba" withString:@""];
-    //conversely, remove the 'rgb' component
-    rgbString = [rgbString stringByReplacingOccurrencesOfString:@"rgb" withString:@""];
-    //remove the brackets
-    rgbString = [rgbString stringByReplacingOccurrencesOfString:@"(" withString:@""];
-    rgbString = [rgbString stringByReplacingOccurrencesOfString:@")" withString:@""];
-    //remove all spaces
-    rgbString = [rgbString stringByReplacingOccurrencesOfString:@" " withString:@""];
-    
-    //we should now have something like '0,0,0'. Split it up via the commas
-    NSArray *componenets = [rgbString componentsSeparatedByString:@","];
-    
-    //Final output componenets
-    CGFloat red, green, blue, alpha = 1.0f;
-    
-    //if the alpha value is 0, this indicates the RGB value wasn't actually set in the page, so just return white
-    if ([componenets count] < 3 || ([componenets count] >= 4 && [[componenets objectAtIndex:3] integerValue] == 0))
+    //if the alpha value is 0, this indicates the colour wasn't actually set in the page, so just return white
+    if (CGColorGetAlpha(color.CGColor) < FLT_EPSILON)
         return [UIColor whiteColor];
     
-    red     = (CGFloat)[[componenets objectAtIndex:0] integerValue] / 255.0f;
-    green   = (CGFloat)[[componenets objectAtIndex:1] integerValue] / 255.0f;
-    blue    = (CGFloat)[[componenets objectAtIndex:2] integerValue] / 255.0f;
-    
-    if ([componenets count] >= 4)
-        alpha = (CGFloat)[[componenets objectAtIndex:3] integerValue] / 255.0f;
-    
-    return [UIColor colorWithRed:red green:green blue:blue alpha:alpha];
+    return color;
 }
 
 #pragma mark -
@@ -1407,8 +2525,8 @@
 /* Called outside of the animation block. All of the views are currently in their 'before' state. */
 - (void)setUpWebViewForRotationToOrientation:(UIInterfaceOrientation)toOrientation withDuration:(NSTimeInterval)duration
 {
-    // Don't perform this if split screen is active
-    if (self.splitScreenEnabled) {
+    // Don't perform this if split screen is active, or the web view is hidden behind reader mode
+    if (self.splitScreenEnabled || self.readerModeEnabled) {
         return;
     }
     
@@ -1439,7 +2557,13 @@
     CGRect  renderBounds            = [self rectForVisibleRegionOfWebViewAnimatingToOrientation:toOrientation];
     
     //generate a snapshot of the webview that we can animate more smoothly
-    CGFloat scale = 1.75f;
+    //(Never above the screen's own scale, and capped to a pixel budget so large iPads
+    //don't have to allocate and fill a huge image buffer right before the animation)
+    CGFloat scale = MIN(ROTATION_SNAPSHOT_MAX_SCALE, [[UIScreen mainScreen] scale]);
+    CGFloat pixelCount = CGRectGetWidth(renderBounds) * CGRectGetHeight(renderBounds) * scale * scale;
+    if (pixelCount > ROTATION_SNAPSHOT_MAX_PIXELS)
+        scale *= sqrt(ROTATION_SNAPSHOT_MAX_PIXELS / pixelCount);
+    
     UIGraphicsBeginImageContextWithOptions(renderBounds.size, YES, scale);
     {
         CGContextRef context = UIGraphicsGetCurrentContext();
@@ -1551,8 +2675,8 @@
 /* Called within the animation block. All views will be set to their 'destination' state. */
 - (void)animateWebViewRotationToOrientation:(UIInterfaceOrientation)toOrientation withDuration:(NSTimeInterval)duration
 {
-    //Don't bother when split screen is active
-    if (self.splitScreenEnabled) {
+    //Don't bother when split screen is active, or when no snapshot was taken for reader mode
+    if (self.splitScreenEnabled || self.webViewRotationSnapshot == nil) {
         return;
     }
     
@@ -1633,8 +2757,8 @@
 
 - (void)restoreWebViewFromRotationFromOrientation:(UIInterfaceOrientation)fromOrientation
 {
-    // Don't perform this if split screen is active
-    if (self.splitScreenEnabled) {
+    // Don't perform this if split screen is active, or the web view was left alone for reader mode
+    if (self.splitScreenEnabled || self.readerModeEnabled) {
         return;
     }
     
@@ -1680,8 +2804,8 @@
 
 - (void)animationDidStop:(CAAnimation *)anim finished:(BOOL)flag
 {
-    //when the rotation and animation is complete, FINALLY unhide the web view
-    self.webView.hidden = NO;
+    //when the rotation and animation is complete, FINALLY unhide the web view (unless reader mode is covering it)
+    self.webView.hidden = self.readerModeEnabled;
 
     CGSize contentSize = self.webView.scrollView.contentSize;
     CGPoint translatedContentOffset = _webViewState.contentOffset;
@@ -0,0 +1,40 @@
+//
+//  TOWebViewPublicSuffix.h
+//
+//  Copyright 2013-2018 Timothy Oliver. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+//  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+//  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Shortens a host name to its registrable domain: its public suffix, plus the one label registered
+ under it (eg, 'news.bbc.co.uk' becomes 'bbc.co.uk', and 'evil.github.io' stays as it is).
+
+ Public suffixes are looked up in a small table taken from the Public Suffix List, covering both
+ its ICANN section and the shared hosting domains in its private section. Two letter country code
+ domains that aren't in the table are treated as having a two label suffix when their second level
+ is a common one (eg 'co', 'com', 'net', 'org').
+
+ IP addresses, and hosts that are already a registrable domain, are returned as they are.
+ */
+NSString *TOWebViewRegistrableDomainForHost(NSString *host);
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,129 @@
+//
+//  TOWebViewPublicSuffix.m
+//
+//  Copyright 2013-2018 Timothy Oliver. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+//  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+//  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#import "TOWebViewPublicSuffix.h"
+
+/*
+ Rules taken from the Public Suffix List (https://publicsuffix.org/list/), in its format:
+ 'a.b' is a suffix, '*.a.b' makes every label under 'a.b' a suffix, and '!c.a.b' is an exception to a wildcard.
+ 
+ Only multi-label rules are needed, since every top level domain is a suffix anyway. The two letter
+ country code domains with common second levels (eg 'co.uk', 'com.au') are covered by the fallback below.
+ */
+static const char *TOWebViewPublicSuffixRules[] = {
+    /* ICANN */
+    "ltd.uk", "me.uk", "nhs.uk", "plc.uk", "police.uk", "*.sch.uk",
+    "asn.au", "id.au",
+    "geek.nz", "gen.nz", "govt.nz", "iwi.nz", "school.nz",
+    "ad.jp", "ed.jp", "gr.jp", "lg.jp", "*.kawasaki.jp", "!city.kawasaki.jp", "*.kobe.jp", "!city.kobe.jp",
+    "firm.in", "gen.in", "ind.in",
+    "web.za",
+    "*.bd", "*.ck", "!www.ck", "*.er", "*.fk", "*.jm", "*.kh", "*.mm", "*.np", "*.pg",
+    
+    /* Private (Domains that hand out subdomains to their users) */
+    "br.com", "cn.com", "de.com", "eu.com", "uk.com", "us.com", "za.com", "gb.net", "uk.net",
+    "github.io", "githubusercontent.com", "gitlab.io", "bitbucket.io", "readthedocs.io",
+    "blogspot.com", "blogspot.ca", "blogspot.co.uk", "blogspot.com.au", "blogspot.com.br",
+    "blogspot.de", "blogspot.fr", "blogspot.in", "blogspot.jp", "blogspot.mx",
+    "appspot.com", "firebaseapp.com", "web.app", "translate.goog",
+    "herokuapp.com", "herokussl.com",
+    "cloudfront.net", "s3.amazonaws.com", "*.compute.amazonaws.com", "*.compute-1.amazonaws.com", "elasticbeanstalk.com",
+    "azurewebsites.net", "cloudapp.net", "azurestaticapps.net",
+    "netlify.app", "vercel.app", "now.sh", "pages.dev", "workers.dev", "fly.dev", "onrender.com", "surge.sh",
+    "glitch.me", "ngrok.io", "myshopify.com", "wixsite.com", "000webhostapp.com", "neocities.org",
+    "dyndns.org", "duckdns.org"
+};
+
+NSString *TOWebViewRegistrableDomainForHost(NSString *host)
+{
+    //IPv6 addresses can't be shortened
+    if (host.length == 0 || [host rangeOfString:@":"].location != NSNotFound)
+        return host;
+    
+    NSString *lowercaseHost = [host lowercaseString];
+    if ([lowercaseHost hasSuffix:@"."])
+        lowercaseHost = [lowercaseHost substringToIndex:lowercaseHost.length - 1];
+    
+    NSArray *labels = [lowercaseHost componentsSeparatedByString:@"."];
+    NSInteger numberOfLabels = labels.count;
+    if (numberOfLabels <= 2)
+        return host;
+    
+    //Neither can IPv4 addresses
+    NSString *topLevelDomain = labels.lastObject;
+    if ([topLevelDomain rangeOfCharacterFromSet:[[NSCharacterSet decimalDigitCharacterSet] invertedSet]].location == NSNotFound)
+        return host;
+    
+    static NSSet *suffixes = nil, *wildcardSuffixes = nil, *exceptionSuffixes = nil, *secondLevelDomains = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        NSMutableSet *rules = [NSMutableSet set], *wildcardRules = [NSMutableSet set], *exceptionRules = [NSMutableSet set];
+        for (size_t i = 0; i < sizeof(TOWebViewPublicSuffixRules) / sizeof(TOWebViewPublicSuffixRules[0]); i++) {
+            NSString *rule = @(TOWebViewPublicSuffixRules[i]);
+            if ([rule hasPrefix:@"*."])
+                [wildcardRules addObject:[rule substringFromIndex:2]];
+            else if ([rule hasPrefix:@"!"])
+                [exceptionRules addObject:[rule substringFromIndex:1]];
+            else
+                [rules addObject:rule];
+        }
+        
+        suffixes = [rules copy];
+        wildcardSuffixes = [wildcardRules copy];
+        exceptionSuffixes = [exceptionRules copy];
+        secondLevelDomains = [NSSet setWithObjects:@"ac", @"co", @"com", @"edu", @"go", @"gob", @"gov",
+                                                   @"ne", @"net", @"or", @"org", @"mil", @"nic", nil];
+    });
+    
+    //Find the longest rule that matches the end of the host, by checking each suffix from the longest down
+    NSInteger suffixLabels = 0;
+    NSUInteger offset = 0;
+    for (NSInteger i = 0; i < numberOfLabels && suffixLabels == 0; i++) {
+        NSUInteger nextOffset = offset + [labels[i] length] + 1;
+        NSString *suffix = [lowercaseHost substringFromIndex:offset];
+        
+        if ([exceptionSuffixes containsObject:suffix]) {
+            suffixLabels = numberOfLabels - i - 1;
+        }
+        else if ([suffixes containsObject:suffix] ||
+                 (i + 1 < numberOfLabels && [wildcardSuffixes containsObject:[lowercaseHost substringFromIndex:nextOffset]])) {
+            suffixLabels = numberOfLabels - i;
+        }
+        
+        offset = nextOffset;
+    }
+    
+    //Otherwise, the suffix is just the top level domain, or two labels for common country code second levels
+    if (suffixLabels == 0) {
+        suffixLabels = 1;
+        if (topLevelDomain.length == 2 && [secondLevelDomains containsObject:labels[numberOfLabels - 2]])
+            suffixLabels = 2;
+    }
+    
+    //Keep the public suffix, plus the one label registered under it
+    NSInteger domainLabels = suffixLabels + 1;
+    if (numberOfLabels <= domainLabels)
+        return host;
+    
+    NSArray *domainComponents = [labels subarrayWithRange:NSMakeRange(numberOfLabels - domainLabels, domainLabels)];
+    return [domainComponents componentsJoinedByString:@"."];
+}
@@ -0,0 +1,49 @@
+//
+//  TOWebViewViewport.h
+//
+//  Copyright 2013-2018 Timothy Oliver. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+//  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+//  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#import <UIKit/UIKit.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/* The properties of a page's <meta name="viewport"> tag. Unspecified numeric values are negative. */
+typedef struct {
+    BOOL deviceWidth;
+    CGFloat width;
+    CGFloat initialScale;
+    CGFloat minimumScale;
+    CGFloat maximumScale;
+    BOOL userScalable;
+} TOWebViewViewport;
+
+/**
+ Tokenizes viewport content (eg 'width=device-width, initial-scale=1') into its properties, in a single
+ pass without allocating any memory. Properties may be separated by commas, semicolons or spaces,
+ and unknown properties and values are ignored.
+ */
+void TOWebViewParseViewport(const char * _Nullable string, TOWebViewViewport *viewport);
+
+/**
+ Whether the page lays itself out to the width of the device, rather than being zoomed to fit.
+ */
+BOOL TOWebViewViewportIsDynamic(const TOWebViewViewport *viewport);
+
+NS_ASSUME_NONNULL_END
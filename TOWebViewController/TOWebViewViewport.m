@@ -0,0 +1,114 @@
+//
+//  TOWebViewViewport.m
+//
+//  Copyright 2013-2018 Timothy Oliver. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+//  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+//  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#import "TOWebViewViewport.h"
+#import "TOWebViewCSSColor.h"
+
+static inline BOOL TOWebViewViewportIsSeparator(char character)
+{
+    return (character == ',' || character == ';' || TOWebViewCSSIsSpace(character));
+}
+
+static BOOL TOWebViewViewportTokenEquals(const char *token, size_t length, const char *keyword)
+{
+    if (strlen(keyword) != length) { return NO; }
+    
+    for (size_t i = 0; i < length; i++) {
+        if (TOWebViewCSSLowercase(token[i]) != keyword[i]) { return NO; }
+    }
+    
+    return YES;
+}
+
+static void TOWebViewViewportSetProperty(TOWebViewViewport *viewport, const char *key, size_t keyLength, const char *value, size_t valueLength)
+{
+    CGFloat number = -1.0f;
+    const char *numberCursor = value;
+    BOOL isNumber = (valueLength > 0 && TOWebViewCSSScanNumber(&numberCursor, &number));
+    
+    if (TOWebViewViewportTokenEquals(key, keyLength, "width")) {
+        viewport->deviceWidth = TOWebViewViewportTokenEquals(value, valueLength, "device-width");
+        viewport->width = isNumber ? number : -1.0f;
+    }
+    else if (TOWebViewViewportTokenEquals(key, keyLength, "initial-scale")) {
+        viewport->initialScale = isNumber ? number : -1.0f;
+    }
+    else if (TOWebViewViewportTokenEquals(key, keyLength, "minimum-scale")) {
+        viewport->minimumScale = isNumber ? number : -1.0f;
+    }
+    else if (TOWebViewViewportTokenEquals(key, keyLength, "maximum-scale")) {
+        viewport->maximumScale = isNumber ? number : -1.0f;
+    }
+    else if (TOWebViewViewportTokenEquals(key, keyLength, "user-scalable")) {
+        if (isNumber) {
+            viewport->userScalable = (fabs(number) >= 1.0f);
+        }
+        else {
+            viewport->userScalable = !TOWebViewViewportTokenEquals(value, valueLength, "no");
+        }
+    }
+}
+
+void TOWebViewParseViewport(const char *string, TOWebViewViewport *viewport)
+{
+    *viewport = (TOWebViewViewport){NO, -1.0f, -1.0f, -1.0f, -1.0f, YES};
+    if (string == NULL) { return; }
+    
+    const char *cursor = string;
+    while (*cursor) {
+        while (*cursor && TOWebViewViewportIsSeparator(*cursor)) { cursor++; }
+        if (*cursor == '\0') { break; }
+        
+        const char *key = cursor;
+        while (*cursor && *cursor != '=' && !TOWebViewViewportIsSeparator(*cursor)) { cursor++; }
+        size_t keyLength = (size_t)(cursor - key);
+        
+        //Spaces are allowed either side of the '='
+        cursor = TOWebViewCSSSkipSpaces(cursor);
+        if (*cursor != '=') {
+            continue;
+        }
+        
+        cursor = TOWebViewCSSSkipSpaces(cursor + 1);
+        const char *value = cursor;
+        while (*cursor && *cursor != '=' && !TOWebViewViewportIsSeparator(*cursor)) { cursor++; }
+        
+        TOWebViewViewportSetProperty(viewport, key, keyLength, value, (size_t)(cursor - value));
+    }
+}
+
+BOOL TOWebViewViewportIsDynamic(const TOWebViewViewport *viewport)
+{
+    //the max page zoom is locked at 1 (or less)
+    if (viewport->maximumScale >= 0.0f && viewport->maximumScale <= 1.0f + FLT_EPSILON) { return YES; }
+    
+    //zooming is intentionally disabled
+    if (viewport->userScalable == NO) { return YES; }
+    
+    //width is set to align to the width of the device
+    if (viewport->deviceWidth) { return YES; }
+    
+    //initial scale is being forced (Apple seem to blanket apply this in Safari)
+    if (fabs(viewport->initialScale - 1.0f) < FLT_EPSILON) { return YES; }
+    
+    return NO;
+}
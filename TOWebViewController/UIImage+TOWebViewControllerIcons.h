@@ -28,11 +28,14 @@ extern const NSString *TOWebViewControllerButtonBevelOpacity;
 
 @interface UIImage (TOWebViewControllerIcons)
 
-/* Navigation Buttons */
+/* Navigation Buttons (Rendered once per theme and screen scale, and cached thereafter) */
 + (instancetype)TOWebViewControllerIcon_backButtonWithAttributes:(NSDictionary *)attributes;
 + (instancetype)TOWebViewControllerIcon_forwardButtonWithAttributes:(NSDictionary *)attributes;
 + (instancetype)TOWebViewControllerIcon_refreshButtonWithAttributes:(NSDictionary *)attributes;
 + (instancetype)TOWebViewControllerIcon_stopButtonWithAttributes:(NSDictionary *)attributes;
 + (instancetype)TOWebViewControllerIcon_actionButtonWithAttributes:(NSDictionary *)attributes;
 
+/* Renders every navigation icon into the cache on a background queue, ahead of when they're needed */
++ (void)TOWebViewControllerIcon_prepareIconsWithAttributes:(NSDictionary *)attributes;
+
 @end
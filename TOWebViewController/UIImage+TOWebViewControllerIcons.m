@@ -42,12 +42,24 @@ const NSString *TOWebViewControllerButtonBevelOpacity    = @"TOWebViewController
 /* Detect which user idiom we're running on */
 #define IPAD (UI_USER_INTERFACE_IDIOM() == UIUserInterfaceIdiomPad)
 
+/* The number of rendered icons kept around, across every theme and screen scale */
+#define ICON_CACHE_COUNT_LIMIT  40
+
 @interface UIImage (private)
 
 + (UIColor *)fillColorFromAttributes:(NSDictionary *)attributes;
 + (CGFloat)bevelOpacityFromAttributes:(NSDictionary *)attributes;
 + (void)drawBevelFromFillColor:(UIColor *)fillColor opacity:(CGFloat)opacity;
 
++ (NSCache *)iconCache;
++ (UIImage *)cachedIconNamed:(NSString *)name attributes:(NSDictionary *)attributes drawingBlock:(UIImage *(^)(void))drawingBlock;
+
++ (UIImage *)backButtonImageWithAttributes:(NSDictionary *)attributes;
++ (UIImage *)forwardButtonImageWithAttributes:(NSDictionary *)attributes;
++ (UIImage *)refreshButtonImageWithAttributes:(NSDictionary *)attributes;
++ (UIImage *)stopButtonImageWithAttributes:(NSDictionary *)attributes;
++ (UIImage *)actionButtonImageWithAttributes:(NSDictionary *)attributes;
+
 @end
 
 @implementation UIImage (TOWebViewControllerIcons)
@@ -107,8 +119,105 @@ const NSString *TOWebViewControllerButtonBevelOpacity    = @"TOWebViewController
         CGContextTranslateCTM(context, 0, 1.0f);
 }
 
+#pragma mark - Icon Cache -
++ (NSCache *)iconCache
+{
+    static NSCache *iconCache = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        iconCache = [[NSCache alloc] init];
+        iconCache.countLimit = ICON_CACHE_COUNT_LIMIT;
+    });
+    
+    return iconCache;
+}
+
++ (UIImage *)cachedIconNamed:(NSString *)name attributes:(NSDictionary *)attributes drawingBlock:(UIImage *(^)(void))drawingBlock
+{
+    //On iOS 7 and up, icons are drawn as black templates, so the theming attributes don't affect them
+    NSString *key = nil;
+    CGFloat scale = [[UIScreen mainScreen] scale];
+    if (MINIMAL_UI) {
+        key = [NSString stringWithFormat:@"%@-%.1f", name, scale];
+    }
+    else {
+        //Key the colour by its RGB components, so equal colours from different colour spaces share an icon
+        //(Colours that can't be converted, like patterns, fall back to being keyed by their description)
+        UIColor *fillColor = [UIImage fillColorFromAttributes:attributes];
+        CGFloat bevelOpacity = [UIImage bevelOpacityFromAttributes:attributes];
+        CGFloat red, green, blue, alpha;
+        NSString *colorKey = nil;
+        if ([fillColor getRed:&red green:&green blue:&blue alpha:&alpha])
+            colorKey = [NSString stringWithFormat:@"%.4f,%.4f,%.4f,%.4f", red, green, blue, alpha];
+        else
+            colorKey = fillColor.description;
+        
+        key = [NSString stringWithFormat:@"%@-%@-%.3f-%.1f", name, colorKey, bevelOpacity, scale];
+    }
+    
+    NSCache *iconCache = [UIImage iconCache];
+    UIImage *image = [iconCache objectForKey:key];
+    if (image == nil) {
+        image = drawingBlock();
+        if (image) {
+            [iconCache setObject:image forKey:key];
+        }
+    }
+    
+    return image;
+}
+
 #pragma mark - Navigation Buttons -
 + (instancetype)TOWebViewControllerIcon_backButtonWithAttributes:(NSDictionary *)attributes
+{
+    return [UIImage cachedIconNamed:@"back" attributes:attributes drawingBlock:^UIImage *{
+        return [UIImage backButtonImageWithAttributes:attributes];
+    }];
+}
+
++ (instancetype)TOWebViewControllerIcon_forwardButtonWithAttributes:(NSDictionary *)attributes
+{
+    return [UIImage cachedIconNamed:@"forward" attributes:attributes drawingBlock:^UIImage *{
+        return [UIImage forwardButtonImageWithAttributes:attributes];
+    }];
+}
+
++ (instancetype)TOWebViewControllerIcon_refreshButtonWithAttributes:(NSDictionary *)attributes
+{
+    return [UIImage cachedIconNamed:@"refresh" attributes:attributes drawingBlock:^UIImage *{
+        return [UIImage refreshButtonImageWithAttributes:attributes];
+    }];
+}
+
++ (instancetype)TOWebViewControllerIcon_stopButtonWithAttributes:(NSDictionary *)attributes
+{
+    return [UIImage cachedIconNamed:@"stop" attributes:attributes drawingBlock:^UIImage *{
+        return [UIImage stopButtonImageWithAttributes:attributes];
+    }];
+}
+
++ (instancetype)TOWebViewControllerIcon_actionButtonWithAttributes:(NSDictionary *)attributes
+{
+    return [UIImage cachedIconNamed:@"action" attributes:attributes drawingBlock:^UIImage *{
+        return [UIImage actionButtonImageWithAttributes:attributes];
+    }];
+}
+
++ (void)TOWebViewControllerIcon_prepareIconsWithAttributes:(NSDictionary *)attributes
+{
+    //UIKit image contexts are safe to draw into off the main thread, and the cache is thread-safe
+    NSDictionary *iconAttributes = [attributes copy];
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        [UIImage TOWebViewControllerIcon_backButtonWithAttributes:iconAttributes];
+        [UIImage TOWebViewControllerIcon_forwardButtonWithAttributes:iconAttributes];
+        [UIImage TOWebViewControllerIcon_refreshButtonWithAttributes:iconAttributes];
+        [UIImage TOWebViewControllerIcon_stopButtonWithAttributes:iconAttributes];
+        [UIImage TOWebViewControllerIcon_actionButtonWithAttributes:iconAttributes];
+    });
+}
+
+#pragma mark - Icon Drawing -
++ (UIImage *)backButtonImageWithAttributes:(NSDictionary *)attributes
 {
     UIImage *backButtonImage = nil;
     if (MINIMAL_UI) {
@@ -163,7 +272,7 @@ const NSString *TOWebViewControllerButtonBevelOpacity    = @"TOWebViewController
     return backButtonImage;
 }
 
-+ (instancetype)TOWebViewControllerIcon_forwardButtonWithAttributes:(NSDictionary *)attributes
++ (UIImage *)forwardButtonImageWithAttributes:(NSDictionary *)attributes
 {
     UIImage *forwardButtonImage = nil;
     if (MINIMAL_UI) {
@@ -218,7 +327,7 @@ const NSString *TOWebViewControllerButtonBevelOpacity    = @"TOWebViewController
     return forwardButtonImage;
 }
 
-+ (instancetype)TOWebViewControllerIcon_refreshButtonWithAttributes:(NSDictionary *)attributes
++ (UIImage *)refreshButtonImageWithAttributes:(NSDictionary *)attributes
 {
     UIImage *refreshButtonImage = nil;
     if (MINIMAL_UI) {
@@ -289,7 +398,7 @@ const NSString *TOWebViewControllerButtonBevelOpacity    = @"TOWebViewController
     return refreshButtonImage;
 }
 
-+ (instancetype)TOWebViewControllerIcon_stopButtonWithAttributes:(NSDictionary *)attributes
++ (UIImage *)stopButtonImageWithAttributes:(NSDictionary *)attributes
 {
     UIImage *stopButtonImage = nil;
     if (MINIMAL_UI) {
@@ -359,7 +468,7 @@ const NSString *TOWebViewControllerButtonBevelOpacity    = @"TOWebViewController
     return stopButtonImage;
 }
 
-+ (instancetype)TOWebViewControllerIcon_actionButtonWithAttributes:(NSDictionary *)attributes
++ (UIImage *)actionButtonImageWithAttributes:(NSDictionary *)attributes
 {
     UIImage *actionButtonImage = nil;
     if (MINIMAL_UI) {
@@ -8,11 +8,15 @@
 
 #import "TOAppDelegate.h"
 #import "TOViewController.h"
+#import "TOWebViewController.h"
 
 @implementation TOAppDelegate
 
 - (BOOL)application:(UIApplication *)application didFinishLaunchingWithOptions:(NSDictionary *)launchOptions
 {
+    //Render the web view controller's icons in the background before they're needed
+    [TOWebViewController prepareIcons];
+    
     //Create the main window
     self.window = [[UIWindow alloc] initWithFrame:[[UIScreen mainScreen] bounds]];
     